@@ -1,99 +1,218 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "Minesweeper.h"
-#include "MinesweeperStyle.h"
-#include "MinesweeperCommands.h"
-#include "LevelEditor.h"
-#include "Widgets/Docking/SDockTab.h"
-#include "ToolMenus.h"
-
-#include "SMinesweeper.h"
-
-static const FName MinesweeperTabName("Minesweeper");
-
-#define LOCTEXT_NAMESPACE "FMinesweeperModule"
-
-void FMinesweeperModule::StartupModule()
-{
-	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
-	
-	FMinesweeperStyle::Initialize();
-	FMinesweeperStyle::ReloadTextures();
-
-	FMinesweeperCommands::Register();
-	
-	PluginCommands = MakeShareable(new FUICommandList);
-
-	PluginCommands->MapAction(
-		FMinesweeperCommands::Get().OpenPluginWindow,
-		FExecuteAction::CreateRaw(this, &FMinesweeperModule::PluginButtonClicked),
-		FCanExecuteAction());
-
-	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FMinesweeperModule::RegisterMenus));
-	
-	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(MinesweeperTabName, FOnSpawnTab::CreateRaw(this, &FMinesweeperModule::OnSpawnPluginTab))
-		.SetDisplayName(LOCTEXT("FMinesweeperTabTitle", "Minesweeper"))
-		.SetMenuType(ETabSpawnerMenuType::Hidden);
-}
-
-void FMinesweeperModule::ShutdownModule()
-{
-	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
-	// we call this function before unloading the module.
-
-	UToolMenus::UnRegisterStartupCallback(this);
-
-	UToolMenus::UnregisterOwner(this);
-
-	FMinesweeperStyle::Shutdown();
-
-	FMinesweeperCommands::Unregister();
-
-	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(MinesweeperTabName);
-}
-
-TSharedRef<SDockTab> FMinesweeperModule::OnSpawnPluginTab(const FSpawnTabArgs& SpawnTabArgs)
-{
-	return SNew(SDockTab)
-		.TabRole(ETabRole::NomadTab)
-		[
-			SNew(SBox)
-			[
-				SNew(SMinesweeper)
-			]
-		];
-}
-
-void FMinesweeperModule::PluginButtonClicked()
-{
-	FGlobalTabmanager::Get()->TryInvokeTab(MinesweeperTabName);
-}
-
-void FMinesweeperModule::RegisterMenus()
-{
-	// Owner will be used for cleanup in call to UToolMenus::UnregisterOwner
-	FToolMenuOwnerScoped OwnerScoped(this);
-
-	{
-		UToolMenu* Menu = UToolMenus::Get()->ExtendMenu("LevelEditor.MainMenu.Window");
-		{
-			FToolMenuSection& Section = Menu->FindOrAddSection("WindowLayout");
-			Section.AddMenuEntryWithCommandList(FMinesweeperCommands::Get().OpenPluginWindow, PluginCommands);
-		}
-	}
-
-	{
-		UToolMenu* ToolbarMenu = UToolMenus::Get()->ExtendMenu("LevelEditor.LevelEditorToolBar");
-		{
-			FToolMenuSection& Section = ToolbarMenu->FindOrAddSection("Settings");
-			{
-				FToolMenuEntry& Entry = Section.AddEntry(FToolMenuEntry::InitToolBarButton(FMinesweeperCommands::Get().OpenPluginWindow));
-				Entry.SetCommandList(PluginCommands);
-			}
-		}
-	}
-}
-
-#undef LOCTEXT_NAMESPACE
-	
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Minesweeper.h"
+#include "MinesweeperStyle.h"
+#include "MinesweeperCommands.h"
+#include "LevelEditor.h"
+#include "Widgets/Docking/SDockTab.h"
+#include "ToolMenus.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "MinesweeperBenchmark.h"
+#include "MinesweeperBoard.h"
+#include "MinesweeperRecording.h"
+#include "MinesweeperSimulation.h"
+#include "SMinesweeper.h"
+
+DEFINE_LOG_CATEGORY(LogMinesweeper);
+
+static const FName MinesweeperTabName("Minesweeper");
+
+#define LOCTEXT_NAMESPACE "FMinesweeperModule"
+
+void FMinesweeperModule::StartupModule()
+{
+	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	
+	FMinesweeperStyle::Initialize();
+	FMinesweeperStyle::ReloadTextures();
+
+	FMinesweeperCommands::Register();
+	
+	PluginCommands = MakeShareable(new FUICommandList);
+
+	PluginCommands->MapAction(
+		FMinesweeperCommands::Get().OpenPluginWindow,
+		FExecuteAction::CreateRaw(this, &FMinesweeperModule::PluginButtonClicked),
+		FCanExecuteAction());
+
+	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FMinesweeperModule::RegisterMenus));
+	
+	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(MinesweeperTabName, FOnSpawnTab::CreateRaw(this, &FMinesweeperModule::OnSpawnPluginTab))
+		.SetDisplayName(LOCTEXT("FMinesweeperTabTitle", "Minesweeper"))
+		.SetMenuType(ETabSpawnerMenuType::Hidden);
+
+	SimulateCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("Minesweeper.Simulate"),
+		TEXT("Plays games with a bot and logs win rate, reveals, cascades and throughput.\n")
+		TEXT("Usage: Minesweeper.Simulate [Games] [Seed] [Width Height Mines]...\n")
+		TEXT("Without any sizes, the beginner, intermediate and expert boards are played"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&FMinesweeperModule::Simulate),
+		ECVF_Default);
+
+	BenchmarkCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("Minesweeper.Benchmark"),
+		TEXT("Times board generation, counting, the worst cascade and revealing the whole board on fixed seeds,\n")
+		TEXT("and saves the results to Saved/Minesweeper as CSV and JSON.\n")
+		TEXT("Usage: Minesweeper.Benchmark [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&FMinesweeperModule::Benchmark),
+		ECVF_Default);
+
+	ReplayCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("Minesweeper.Replay"),
+		TEXT("Replays every game in a log of recorded inputs as fast as it can, and logs how long each took.\n")
+		TEXT("Usage: Minesweeper.Replay [Filename]\n")
+		TEXT("Without a filename, the games recorded in the editor are replayed"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&FMinesweeperModule::Replay),
+		ECVF_Default);
+}
+
+void FMinesweeperModule::ShutdownModule()
+{
+	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
+	// we call this function before unloading the module.
+
+	UToolMenus::UnRegisterStartupCallback(this);
+
+	UToolMenus::UnregisterOwner(this);
+
+	FMinesweeperStyle::Shutdown();
+
+	FMinesweeperCommands::Unregister();
+
+	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(MinesweeperTabName);
+
+	IConsoleManager::Get().UnregisterConsoleObject(SimulateCommand);
+	SimulateCommand = nullptr;
+	IConsoleManager::Get().UnregisterConsoleObject(BenchmarkCommand);
+	BenchmarkCommand = nullptr;
+	IConsoleManager::Get().UnregisterConsoleObject(ReplayCommand);
+	ReplayCommand = nullptr;
+}
+
+TSharedRef<SDockTab> FMinesweeperModule::OnSpawnPluginTab(const FSpawnTabArgs& SpawnTabArgs)
+{
+	return SNew(SDockTab)
+		.TabRole(ETabRole::NomadTab)
+		[
+			SNew(SBox)
+			[
+				SNew(SMinesweeper)
+			]
+		];
+}
+
+void FMinesweeperModule::PluginButtonClicked()
+{
+	FGlobalTabmanager::Get()->TryInvokeTab(MinesweeperTabName);
+}
+
+void FMinesweeperModule::RegisterMenus()
+{
+	// Owner will be used for cleanup in call to UToolMenus::UnregisterOwner
+	FToolMenuOwnerScoped OwnerScoped(this);
+
+	{
+		UToolMenu* Menu = UToolMenus::Get()->ExtendMenu("LevelEditor.MainMenu.Window");
+		{
+			FToolMenuSection& Section = Menu->FindOrAddSection("WindowLayout");
+			Section.AddMenuEntryWithCommandList(FMinesweeperCommands::Get().OpenPluginWindow, PluginCommands);
+		}
+	}
+
+	{
+		UToolMenu* ToolbarMenu = UToolMenus::Get()->ExtendMenu("LevelEditor.LevelEditorToolBar");
+		{
+			FToolMenuSection& Section = ToolbarMenu->FindOrAddSection("Settings");
+			{
+				FToolMenuEntry& Entry = Section.AddEntry(FToolMenuEntry::InitToolBarButton(FMinesweeperCommands::Get().OpenPluginWindow));
+				Entry.SetCommandList(PluginCommands);
+			}
+		}
+	}
+}
+
+void FMinesweeperModule::Simulate(const TArray<FString>& Args)
+{
+	const int32 NumGames = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+	const uint64 Seed = Args.Num() > 1 ? FCString::Strtoui64(*Args[1], nullptr, 10) : 0;
+
+	TArray<FMinesweeperSimulationConfig> Configs;
+	for (int32 ArgIndex = 2; ArgIndex + 2 < Args.Num(); ArgIndex += 3)
+	{
+		Configs.Emplace(FCString::Atoi(*Args[ArgIndex]), FCString::Atoi(*Args[ArgIndex + 1]), FCString::Atoi(*Args[ArgIndex + 2]), NumGames, Seed);
+	}
+
+	if (Configs.Num() == 0)
+	{
+		Configs.Emplace(9, 9, 10, NumGames, Seed);
+		Configs.Emplace(16, 16, 40, NumGames, Seed);
+		Configs.Emplace(30, 16, 99, NumGames, Seed);
+	}
+
+	for (const FMinesweeperSimulationConfig& Config : Configs)
+	{
+		// Boards the generator can't fill are skipped rather than played as a run of empty games
+		if (Config.Width < 1 || Config.Height < 1 || Config.MinesCount < 1 || Config.MinesCount >= int64(Config.Width) * Config.Height || Config.NumGames < 1)
+		{
+			UE_LOG(LogMinesweeper, Warning, TEXT("Skipping %dx%d with %d mines, it can't be played"), Config.Width, Config.Height, Config.MinesCount);
+			continue;
+		}
+
+		UE_LOG(LogMinesweeper, Display, TEXT("%s"), *FMinesweeperSimulation::Run(Config).ToString());
+	}
+}
+
+void FMinesweeperModule::Benchmark(const TArray<FString>& Args)
+{
+	const int32 NumIterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 5;
+
+	// The bitboard is only worth timing if it plays exactly the same game as the board
+	const int32 NumBitboardMismatches = FMinesweeperBenchmark::VerifyBitboard();
+	if (NumBitboardMismatches > 0)
+	{
+		UE_LOG(LogMinesweeper, Error, TEXT("Bitboard disagreed with the board on %d random boards"), NumBitboardMismatches);
+	}
+
+	const TArray<FMinesweeperBenchmarkResult> Results = FMinesweeperBenchmark::Run(NumIterations);
+
+	const FString CSV = FMinesweeperBenchmark::ToCSV(Results);
+	UE_LOG(LogMinesweeper, Display, TEXT("Benchmark results:\n%s"), *CSV);
+
+	const FString OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Minesweeper"));
+	const FString CSVPath = FPaths::Combine(OutputDir, TEXT("Benchmark.csv"));
+	const FString JSONPath = FPaths::Combine(OutputDir, TEXT("Benchmark.json"));
+
+	if (FFileHelper::SaveStringToFile(CSV, *CSVPath) && FFileHelper::SaveStringToFile(FMinesweeperBenchmark::ToJSON(Results), *JSONPath))
+	{
+		UE_LOG(LogMinesweeper, Display, TEXT("Saved benchmark results to %s and %s"), *CSVPath, *JSONPath);
+	}
+	else
+	{
+		UE_LOG(LogMinesweeper, Warning, TEXT("Couldn't save benchmark results to %s"), *OutputDir);
+	}
+}
+
+void FMinesweeperModule::Replay(const TArray<FString>& Args)
+{
+	const FString Filename = Args.Num() > 0 ? Args[0] : FMinesweeperRecorder::GetDefaultFilename();
+
+	TArray<FMinesweeperRecordedGame> Games;
+	if (!FMinesweeperReplay::LoadFromFile(*Filename, Games))
+	{
+		UE_LOG(LogMinesweeper, Warning, TEXT("Couldn't read recorded games from %s"), *Filename);
+		return;
+	}
+
+	// Games are replayed one after another on the same board, as they were played
+	FMinesweeperBoard Board;
+	for (const FMinesweeperRecordedGame& Game : Games)
+	{
+		UE_LOG(LogMinesweeper, Display, TEXT("%s"), *FMinesweeperReplay::Play(Game, Board).ToString(Game));
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
+	
 IMPLEMENT_MODULE(FMinesweeperModule, Minesweeper)
\ No newline at end of file
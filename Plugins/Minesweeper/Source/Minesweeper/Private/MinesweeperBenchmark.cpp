@@ -0,0 +1,292 @@
+﻿#include "MinesweeperBenchmark.h"
+
+#include "MinesweeperBitboard.h"
+#include "MinesweeperBoard.h"
+#include "MinesweeperRandomStream.h"
+#include "MinesweeperSnapshot.h"
+
+// Every benchmark uses the same seed, so results can be compared between runs and between changes to the engine
+#define BENCHMARK_SEED 0x4D696E6573ull
+
+// Mine density of the boards which are generated, counted and revealed, which is expert density
+#define BENCHMARK_DENSITY 0.2
+
+// Mine density of the board used for the cascade, low enough that almost the whole board opens at once
+#define CASCADE_DENSITY 0.001
+
+namespace MinesweeperBenchmark
+{
+	/* Time Body NumIterations times, calling Setup untimed before each, and record the best time, and how much the
+	 * memory GetAllocatedSize reports grew by in the worst iteration and how much it holds at the end
+	 */
+	template <typename SetupType, typename BodyType, typename AllocatedSizeType>
+	static void Measure(FMinesweeperBenchmarkResult& Result, int32 NumIterations, SetupType Setup, BodyType Body, AllocatedSizeType GetAllocatedSize)
+	{
+		Result.NumIterations = NumIterations;
+		Result.BestSeconds = TNumericLimits<double>::Max();
+
+		for (int32 Iteration = 0; Iteration < NumIterations; Iteration++)
+		{
+			Setup();
+
+			const int64 StartAllocatedSize = int64(GetAllocatedSize());
+			const double StartSeconds = FPlatformTime::Seconds();
+
+			Body();
+
+			const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+			Result.BestSeconds = FMath::Min(Result.BestSeconds, Seconds);
+			Result.AllocatedSizeGrowth = FMath::Max(Result.AllocatedSizeGrowth, int64(GetAllocatedSize()) - StartAllocatedSize);
+		}
+
+		Result.BoardAllocatedSize = GetAllocatedSize();
+	}
+}
+
+const TArray<int32>& FMinesweeperBenchmark::GetBoardSizes()
+{
+	static const TArray<int32> BoardSizes = { 10, 100, 1000, 4000 };
+	return BoardSizes;
+}
+
+TArray<FMinesweeperBenchmarkResult> FMinesweeperBenchmark::Run(int32 NumIterations)
+{
+	TArray<FMinesweeperBenchmarkResult> Results;
+
+	for (const int32 Size : GetBoardSizes())
+	{
+		const int32 NumCells = Size * Size;
+		const int32 MinesCount = FMath::Max(int32(NumCells * BENCHMARK_DENSITY), 1);
+		const int32 CascadeMinesCount = FMath::Max(int32(NumCells * CASCADE_DENSITY), 1);
+
+		FMinesweeperBoard Board;
+		FMinesweeperBitboard Bitboard;
+
+		auto BoardAllocatedSize = [&Board]() { return Board.GetAllocatedSize(); };
+		auto BitboardAllocatedSize = [&Bitboard]() { return Bitboard.GetAllocatedSize(); };
+
+		auto AddResult = [&](const TCHAR* Name, int32 InMinesCount, int64 InNumCells) -> FMinesweeperBenchmarkResult&
+		{
+			FMinesweeperBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+			Result.Name = Name;
+			Result.Width = Size;
+			Result.Height = Size;
+			Result.MinesCount = InMinesCount;
+			Result.NumCells = InNumCells;
+			return Result;
+		};
+
+		// Generation includes counting, the board is reused between iterations as it is between games
+		{
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("GenerateMinesData"), MinesCount, NumCells);
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[]() {},
+				[&]() { Board.GenerateMinesData(Size, Size, MinesCount, BENCHMARK_SEED); },
+				BoardAllocatedSize);
+		}
+
+		{
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("CountNearbyMines"), MinesCount, NumCells);
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[]() {},
+				[&]() { Board.ComputeNearbyMinesCounts(); },
+				BoardAllocatedSize);
+		}
+
+		{
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("BitboardCountNearbyMines"), MinesCount, NumCells);
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[&]() { Bitboard.InitFromBoard(Board); },
+				[&]() { Bitboard.ComputeNearbyMinesCounts(); },
+				BitboardAllocatedSize);
+
+			ensureMsgf(Bitboard.Matches(Board), TEXT("Bitboard counts differ from the board's on a %dx%d board"), Size, Size);
+		}
+
+		// The worst case for a reveal: a cell with no mines around it on a sparse board, which opens nearly everything
+		{
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("CascadeReveal"), CascadeMinesCount, 0);
+
+			int32 StartingPoint = INDEX_NONE;
+			int32 NumRevealed = 0;
+
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[&]()
+				{
+					StartingPoint = Board.GenerateMinesData(Size, Size, CascadeMinesCount, BENCHMARK_SEED);
+					while (Board.GetCell(StartingPoint).IsMine() || Board.GetCell(StartingPoint).GetNearbyMinesCount() > 0)
+					{
+						StartingPoint = (StartingPoint + 1) % NumCells;
+					}
+				},
+				[&]() { NumRevealed = Board.ActivateCell(StartingPoint); },
+				BoardAllocatedSize);
+
+			Result.NumCells = NumRevealed;
+
+			// The same cascade on the bitboard, from the same board, which has to open exactly the same cells
+			FMinesweeperBenchmarkResult& BitboardResult = AddResult(TEXT("BitboardCascadeReveal"), CascadeMinesCount, 0);
+			MinesweeperBenchmark::Measure(BitboardResult, NumIterations,
+				[&]()
+				{
+					Board.GenerateMinesData(Size, Size, CascadeMinesCount, BENCHMARK_SEED);
+					Bitboard.InitFromBoard(Board);
+				},
+				[&]() { NumRevealed = Bitboard.ActivateCell(StartingPoint); },
+				BitboardAllocatedSize);
+
+			BitboardResult.NumCells = NumRevealed;
+
+			Board.ActivateCell(StartingPoint);
+			ensureMsgf(Bitboard.Matches(Board), TEXT("Bitboard cascade differs from the board's on a %dx%d board"), Size, Size);
+		}
+
+		// Revealing every cell, as happens when a game is lost
+		{
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("RevealAll"), MinesCount, NumCells);
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[&]() { Board.GenerateMinesData(Size, Size, MinesCount, BENCHMARK_SEED); },
+				[&]() { Board.RevealAll(); },
+				BoardAllocatedSize);
+		}
+
+		// Snapshots of the revealed board, so every plane is stored. The data and the board loaded into are reused
+		// between iterations, as they would be when checkpointing the same game
+		TArray<uint8> Snapshot;
+		{
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("SaveSnapshot"), MinesCount, NumCells);
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[]() {},
+				[&]() { FMinesweeperSnapshot::Save(Board, Snapshot); },
+				[&]() { return Snapshot.GetAllocatedSize(); });
+		}
+
+		{
+			FMinesweeperBoard LoadedBoard;
+
+			FMinesweeperBenchmarkResult& Result = AddResult(TEXT("LoadSnapshot"), MinesCount, NumCells);
+			MinesweeperBenchmark::Measure(Result, NumIterations,
+				[]() {},
+				[&]() { FMinesweeperSnapshot::Load(Snapshot, LoadedBoard); },
+				[&]() { return LoadedBoard.GetAllocatedSize(); });
+		}
+	}
+
+	return Results;
+}
+
+int32 FMinesweeperBenchmark::VerifyBitboard(int32 NumBoards, uint64 Seed)
+{
+	FMinesweeperRandomStream RandomStream(Seed);
+	FMinesweeperBoard Board;
+	FMinesweeperBitboard Bitboard;
+
+	int32 NumMismatches = 0;
+
+	for (int32 BoardIndex = 0; BoardIndex < NumBoards; BoardIndex++)
+	{
+		// Widths on either side of a multiple of 64 cover the shifts that carry between the words of a row, and densities
+		// from nearly empty to crowded cover both long cascades and none at all
+		const int32 Width = RandomStream.RandRange(2, 200);
+		const int32 Height = RandomStream.RandRange(2, 100);
+		const int32 MinesCount = RandomStream.RandRange(0, Width * Height * 3 / 10);
+
+		Board.GenerateMinesData(Width, Height, MinesCount, RandomStream.GetUnsignedInt64());
+		Bitboard.InitFromBoard(Board);
+
+		bool bMatches = Bitboard.Matches(Board);
+
+		// Flags are placed on revealed cells too, which both should ignore, and play stops where the board's does
+		for (int32 Move = 0; bMatches && Board.CanPlay() && Move < 50; Move++)
+		{
+			const int32 Idx = RandomStream.RandRange(0, Board.Num() - 1);
+
+			if (RandomStream.RandRange(0, 3) == 0)
+			{
+				Board.ToggleFlag(Idx);
+				Bitboard.ToggleFlag(Idx);
+			}
+			else
+			{
+				bMatches = Board.ActivateCell(Idx) == Bitboard.ActivateCell(Idx);
+			}
+
+			bMatches = bMatches && Bitboard.Matches(Board);
+		}
+
+		// Every other game still going is won, by unflagging and revealing the safe cells left hidden
+		for (int32 Idx = 0; bMatches && Board.CanPlay() && BoardIndex % 2 == 0 && Idx < Board.Num(); Idx++)
+		{
+			const FCellData& Cell = Board.GetCell(Idx);
+			if (Cell.IsMine() || Cell.WasActivated())
+			{
+				continue;
+			}
+
+			if (Cell.IsFlagged())
+			{
+				Board.ToggleFlag(Idx);
+				Bitboard.ToggleFlag(Idx);
+			}
+
+			bMatches = Board.ActivateCell(Idx) == Bitboard.ActivateCell(Idx) && Bitboard.Matches(Board);
+		}
+
+		// Picking up a game that's over, whether it was won or lost, and giving it up must agree as well
+		if (bMatches)
+		{
+			Bitboard.InitFromBoard(Board);
+			bMatches = Bitboard.Matches(Board);
+
+			Board.RevealAll();
+			Bitboard.RevealAll();
+			bMatches = bMatches && Bitboard.Matches(Board) && Bitboard.CanPlay() == Board.CanPlay();
+		}
+
+		NumMismatches += bMatches ? 0 : 1;
+	}
+
+	return NumMismatches;
+}
+
+FString FMinesweeperBenchmark::ToCSV(const TArray<FMinesweeperBenchmarkResult>& Results)
+{
+	FString CSV = TEXT("Benchmark,Width,Height,Mines,Cells,Iterations,BestSeconds,NsPerCell,AllocatedGrowthBytes,BoardAllocatedBytes\n");
+
+	for (const FMinesweeperBenchmarkResult& Result : Results)
+	{
+		CSV += FString::Printf(TEXT("%s,%d,%d,%d,%lld,%d,%.9f,%.3f,%lld,%llu\n"),
+			*Result.Name, Result.Width, Result.Height, Result.MinesCount, Result.NumCells, Result.NumIterations,
+			Result.BestSeconds, Result.GetNanosecondsPerCell(), Result.AllocatedSizeGrowth, uint64(Result.BoardAllocatedSize));
+	}
+
+	return CSV;
+}
+
+FString FMinesweeperBenchmark::ToJSON(const TArray<FMinesweeperBenchmarkResult>& Results)
+{
+	FString JSON = TEXT("[\n");
+
+	for (int32 Index = 0; Index < Results.Num(); Index++)
+	{
+		const FMinesweeperBenchmarkResult& Result = Results[Index];
+
+		JSON += FString::Printf(TEXT("\t{ \"benchmark\": \"%s\", \"width\": %d, \"height\": %d, \"mines\": %d, \"cells\": %lld, \"iterations\": %d, \"best_seconds\": %.9f, \"ns_per_cell\": %.3f, \"allocated_growth_bytes\": %lld, \"board_allocated_bytes\": %llu }%s\n"),
+			*Result.Name, Result.Width, Result.Height, Result.MinesCount, Result.NumCells, Result.NumIterations,
+			Result.BestSeconds, Result.GetNanosecondsPerCell(), Result.AllocatedSizeGrowth, uint64(Result.BoardAllocatedSize),
+			Index < Results.Num() - 1 ? TEXT(",") : TEXT(""));
+	}
+
+	JSON += TEXT("]\n");
+	return JSON;
+}
+
+double FMinesweeperBenchmarkResult::GetNanosecondsPerCell() const
+{
+	return NumCells > 0 ? BestSeconds * 1e9 / double(NumCells) : 0.0;
+}
+
+#undef BENCHMARK_SEED
+#undef BENCHMARK_DENSITY
+#undef CASCADE_DENSITY
@@ -0,0 +1,455 @@
+﻿#include "MinesweeperBitboard.h"
+
+#include "MinesweeperBoard.h"
+
+FMinesweeperBitboard::FMinesweeperBitboard()
+	: Width(0)
+	, Height(0)
+	, WordsPerRow(0)
+	, bCanPlay(false)
+{
+}
+
+void FMinesweeperBitboard::Init(int32 InWidth, int32 InHeight)
+{
+	Width = InWidth;
+	Height = InHeight;
+	WordsPerRow = FMath::DivideAndRoundUp(Width, 64);
+	bCanPlay = true;
+
+	const int32 NumWords = WordsPerRow * Height;
+	Mines.SetNumZeroed(NumWords);
+	Flags.SetNumZeroed(NumWords);
+	Activated.SetNumZeroed(NumWords);
+	for (TArray<uint64>& CountPlane : NearbyCountPlanes)
+	{
+		CountPlane.SetNumZeroed(NumWords);
+	}
+}
+
+void FMinesweeperBitboard::InitFromBoard(const FMinesweeperBoard& Board)
+{
+	Init(Board.GetWidth(), Board.GetHeight());
+
+	for (int32 Idx = 0; Idx < Board.Num(); Idx++)
+	{
+		const FCellData& Cell = Board.GetCell(Idx);
+		const int32 Word = GetWordIndex(Idx);
+		const uint64 Bit = GetBitMask(Idx);
+
+		Mines[Word] |= Cell.IsMine() ? Bit : 0;
+		Flags[Word] |= Cell.IsFlagged() ? Bit : 0;
+		Activated[Word] |= Cell.WasActivated() ? Bit : 0;
+	}
+
+	// The board can't be played once it's won either, but here we only track whether a mine was hit
+	bCanPlay = !Board.HasLost();
+	ComputeNearbyMinesCounts();
+}
+
+void FMinesweeperBitboard::SetMine(int32 Idx)
+{
+	check(Idx < Num())
+
+	Mines[GetWordIndex(Idx)] |= GetBitMask(Idx);
+}
+
+void FMinesweeperBitboard::ComputeNearbyMinesCounts()
+{
+	// Each cell has 8 neighbours. For every word we build the 8 shifted mine planes that line each neighbour up with
+	// the cell, and add them into a 4 bit counter held across 4 words, so 64 cells are counted at once.
+	// The counter is a ripple of half adders: adding a plane to bit 0 carries into bit 1, which carries into bit 2 and so on.
+	for (int32 Row = 0; Row < Height; Row++)
+	{
+		const uint64* Above = Row > 0 ? &Mines[(Row - 1) * WordsPerRow] : nullptr;
+		const uint64* Current = &Mines[Row * WordsPerRow];
+		const uint64* Below = Row < Height - 1 ? &Mines[(Row + 1) * WordsPerRow] : nullptr;
+
+		for (int32 Word = 0; Word < WordsPerRow; Word++)
+		{
+			uint64 Sum[NumCountPlanes] = { 0, 0, 0, 0 };
+
+			auto AddPlane = [&Sum](uint64 Plane)
+			{
+				uint64 Carry = Plane;
+				for (int32 Bit = 0; Bit < NumCountPlanes && Carry != 0; Bit++)
+				{
+					const uint64 NextCarry = Sum[Bit] & Carry;
+					Sum[Bit] ^= Carry;
+					Carry = NextCarry;
+				}
+			};
+
+			if (Above)
+			{
+				AddPlane(ShiftFromLeft(Above, Word));
+				AddPlane(Above[Word]);
+				AddPlane(ShiftFromRight(Above, Word, WordsPerRow));
+			}
+
+			AddPlane(ShiftFromLeft(Current, Word));
+			AddPlane(ShiftFromRight(Current, Word, WordsPerRow));
+
+			if (Below)
+			{
+				AddPlane(ShiftFromLeft(Below, Word));
+				AddPlane(Below[Word]);
+				AddPlane(ShiftFromRight(Below, Word, WordsPerRow));
+			}
+
+			const uint64 ValidMask = GetValidMask(Word);
+			for (int32 Bit = 0; Bit < NumCountPlanes; Bit++)
+			{
+				NearbyCountPlanes[Bit][Row * WordsPerRow + Word] = Sum[Bit] & ValidMask;
+			}
+		}
+	}
+}
+
+int32 FMinesweeperBitboard::ActivateCell(int32 Idx)
+{
+	check(Idx < Num())
+
+	const int32 CellWord = GetWordIndex(Idx);
+	const uint64 CellBit = GetBitMask(Idx);
+
+	if ((Flags[CellWord] & CellBit) || (Activated[CellWord] & CellBit))
+	{
+		return 0;
+	}
+
+	if (Mines[CellWord] & CellBit)
+	{
+		// We've hit a mine!
+		bCanPlay = false;
+		return 0;
+	}
+
+	if (GetNearbyMinesCount(Idx) > 0)
+	{
+		Activated[CellWord] |= CellBit;
+		return 1;
+	}
+
+	// Cascade outward until we've found nearby mines
+	// The cascade can only travel through cells which have no nearby mines and are neither flagged nor already activated,
+	// so we build that mask and then grow the region from the activated cell within it:
+	// 1. Sweep down and then up the board, spreading the region into each row from the row before it and then along the row
+	// 2. Repeat until a full sweep adds nothing, which only takes more than one pass for regions which wind back on themselves
+	// 3. Activate the region along with its border, which is where the cascade found nearby mines
+	// The region covers rows FirstRow to LastRow, and can only grow a row at a time past them, so the mask is only built for
+	// those rows and the one either side as the region reaches them. A small cascade costs its own rows, not the whole board
+	const int32 NumWords = WordsPerRow * Height;
+	CascadeMask.SetNumUninitialized(NumWords);
+	CascadeFill.SetNumUninitialized(NumWords);
+
+	const int32 CellRow = Idx / Width;
+	PrepareCascadeRow(CellRow - 1);
+	PrepareCascadeRow(CellRow);
+	PrepareCascadeRow(CellRow + 1);
+
+	CascadeFill[CellWord] = CellBit;
+	FillRow(&CascadeFill[CellRow * WordsPerRow], &CascadeMask[CellRow * WordsPerRow]);
+
+	int32 FirstRow = CellRow;
+	int32 LastRow = CellRow;
+
+	bool bChanged = true;
+	while (bChanged)
+	{
+		bChanged = false;
+
+		for (int32 Row = FirstRow + 1; Row <= FMath::Min(LastRow + 1, Height - 1); Row++)
+		{
+			if (GrowCascadeRow(Row, Row - 1))
+			{
+				bChanged = true;
+				if (Row > LastRow)
+				{
+					LastRow = Row;
+					PrepareCascadeRow(Row + 1);
+				}
+			}
+		}
+
+		for (int32 Row = LastRow - 1; Row >= FMath::Max(FirstRow - 1, 0); Row--)
+		{
+			if (GrowCascadeRow(Row, Row + 1))
+			{
+				bChanged = true;
+				if (Row < FirstRow)
+				{
+					FirstRow = Row;
+					PrepareCascadeRow(Row - 1);
+				}
+			}
+		}
+	}
+
+	// Only the rows the region covers hold any of it, the rows either side of them are only its border
+	int32 RevealedCount = 0;
+	for (int32 Row = FMath::Max(FirstRow - 1, 0); Row <= FMath::Min(LastRow + 1, Height - 1); Row++)
+	{
+		const uint64* Above = Row > FirstRow ? &CascadeFill[(Row - 1) * WordsPerRow] : nullptr;
+		const uint64* Current = &CascadeFill[Row * WordsPerRow];
+		const uint64* Below = Row < LastRow ? &CascadeFill[(Row + 1) * WordsPerRow] : nullptr;
+
+		for (int32 Word = 0; Word < WordsPerRow; Word++)
+		{
+			uint64 Border = Current[Word] | ShiftFromLeft(Current, Word) | ShiftFromRight(Current, Word, WordsPerRow);
+			if (Above)
+			{
+				Border |= Above[Word] | ShiftFromLeft(Above, Word) | ShiftFromRight(Above, Word, WordsPerRow);
+			}
+			if (Below)
+			{
+				Border |= Below[Word] | ShiftFromLeft(Below, Word) | ShiftFromRight(Below, Word, WordsPerRow);
+			}
+
+			// A cell bordering the region can never be a mine, as it would've stopped the cascade
+			const int32 BoardWord = Row * WordsPerRow + Word;
+			const uint64 NewlyActivated = Border & ~Flags[BoardWord] & ~Activated[BoardWord] & GetValidMask(Word);
+
+			Activated[BoardWord] |= NewlyActivated;
+			RevealedCount += FMath::CountBits(NewlyActivated);
+		}
+	}
+
+	return RevealedCount;
+}
+
+void FMinesweeperBitboard::PrepareCascadeRow(int32 Row)
+{
+	if (Row < 0 || Row >= Height)
+	{
+		return;
+	}
+
+	for (int32 Word = Row * WordsPerRow; Word < (Row + 1) * WordsPerRow; Word++)
+	{
+		const uint64 HasNearbyMines = NearbyCountPlanes[0][Word] | NearbyCountPlanes[1][Word] | NearbyCountPlanes[2][Word] | NearbyCountPlanes[3][Word];
+		CascadeMask[Word] = ~(HasNearbyMines | Mines[Word] | Flags[Word] | Activated[Word]) & GetValidMask(Word % WordsPerRow);
+		CascadeFill[Word] = 0;
+	}
+}
+
+bool FMinesweeperBitboard::GrowCascadeRow(int32 Row, int32 NeighbourRow)
+{
+	if (NeighbourRow < 0 || NeighbourRow >= Height)
+	{
+		return false;
+	}
+
+	uint64* RowFill = &CascadeFill[Row * WordsPerRow];
+	const uint64* RowMask = &CascadeMask[Row * WordsPerRow];
+	const uint64* NeighbourFill = &CascadeFill[NeighbourRow * WordsPerRow];
+
+	uint64 Added = 0;
+	for (int32 Word = 0; Word < WordsPerRow; Word++)
+	{
+		const uint64 Dilated = NeighbourFill[Word] | ShiftFromLeft(NeighbourFill, Word) | ShiftFromRight(NeighbourFill, Word, WordsPerRow);
+		const uint64 NewSeeds = Dilated & RowMask[Word] & ~RowFill[Word];
+
+		RowFill[Word] |= NewSeeds;
+		Added |= NewSeeds;
+	}
+
+	// Rows are always kept filled along their length, so we only need to fill again if the neighbour gave us new seeds
+	if (Added == 0)
+	{
+		return false;
+	}
+
+	FillRow(RowFill, RowMask);
+	return true;
+}
+
+void FMinesweeperBitboard::FillRow(uint64* RowSeeds, const uint64* RowMask) const
+{
+	// Occluded (Kogge-Stone) fills: each step doubles the distance seeds have travelled through the mask.
+	// One pass carries the fill up through the words of the row, a second pass carries it back down, which covers
+	// every run of mask bits that contains a seed, including runs which cross word boundaries.
+	uint64 CarryIn = 0;
+	for (int32 Word = 0; Word < WordsPerRow; Word++)
+	{
+		uint64 Generate = RowSeeds[Word] | (CarryIn & RowMask[Word]);
+		uint64 Propagate = RowMask[Word];
+
+		Generate |= Propagate & (Generate << 1);
+		Propagate &= Propagate << 1;
+		Generate |= Propagate & (Generate << 2);
+		Propagate &= Propagate << 2;
+		Generate |= Propagate & (Generate << 4);
+		Propagate &= Propagate << 4;
+		Generate |= Propagate & (Generate << 8);
+		Propagate &= Propagate << 8;
+		Generate |= Propagate & (Generate << 16);
+		Propagate &= Propagate << 16;
+		Generate |= Propagate & (Generate << 32);
+
+		RowSeeds[Word] = Generate;
+		CarryIn = Generate >> 63;
+	}
+
+	CarryIn = 0;
+	for (int32 Word = WordsPerRow - 1; Word >= 0; Word--)
+	{
+		uint64 Generate = RowSeeds[Word] | ((CarryIn << 63) & RowMask[Word]);
+		uint64 Propagate = RowMask[Word];
+
+		Generate |= Propagate & (Generate >> 1);
+		Propagate &= Propagate >> 1;
+		Generate |= Propagate & (Generate >> 2);
+		Propagate &= Propagate >> 2;
+		Generate |= Propagate & (Generate >> 4);
+		Propagate &= Propagate >> 4;
+		Generate |= Propagate & (Generate >> 8);
+		Propagate &= Propagate >> 8;
+		Generate |= Propagate & (Generate >> 16);
+		Propagate &= Propagate >> 16;
+		Generate |= Propagate & (Generate >> 32);
+
+		RowSeeds[Word] = Generate;
+		CarryIn = Generate & 1;
+	}
+}
+
+void FMinesweeperBitboard::RevealAll()
+{
+	// As on the board, revealed cells can't be flagged and giving the game up ends it
+	for (int32 Word = 0; Word < Activated.Num(); Word++)
+	{
+		Activated[Word] = GetValidMask(Word % WordsPerRow);
+		Flags[Word] = 0;
+	}
+
+	bCanPlay = false;
+}
+
+void FMinesweeperBitboard::ToggleFlag(int32 Idx)
+{
+	check(Idx < Num())
+
+	// Revealed cells can't be flagged, the same as on the board
+	const int32 Word = GetWordIndex(Idx);
+	const uint64 Bit = GetBitMask(Idx);
+	Flags[Word] ^= Bit & ~Activated[Word];
+}
+
+bool FMinesweeperBitboard::CanPlay() const
+{
+	return bCanPlay;
+}
+
+bool FMinesweeperBitboard::Matches(const FMinesweeperBoard& Board) const
+{
+	if (Board.GetWidth() != Width || Board.GetHeight() != Height || Board.HasLost() == bCanPlay)
+	{
+		return false;
+	}
+
+	for (int32 Idx = 0; Idx < Num(); Idx++)
+	{
+		const FCellData& Cell = Board.GetCell(Idx);
+		if (Cell.IsMine() != IsMine(Idx) || Cell.IsFlagged() != IsFlagged(Idx) || Cell.WasActivated() != WasActivated(Idx)
+			|| Cell.GetNearbyMinesCount() != GetNearbyMinesCount(Idx))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FMinesweeperBitboard::IsMine(int32 Idx) const
+{
+	check(Idx < Num())
+
+	return (Mines[GetWordIndex(Idx)] & GetBitMask(Idx)) != 0;
+}
+
+bool FMinesweeperBitboard::IsFlagged(int32 Idx) const
+{
+	check(Idx < Num())
+
+	return (Flags[GetWordIndex(Idx)] & GetBitMask(Idx)) != 0;
+}
+
+bool FMinesweeperBitboard::WasActivated(int32 Idx) const
+{
+	check(Idx < Num())
+
+	return (Activated[GetWordIndex(Idx)] & GetBitMask(Idx)) != 0;
+}
+
+int32 FMinesweeperBitboard::GetNearbyMinesCount(int32 Idx) const
+{
+	check(Idx < Num())
+
+	const int32 Word = GetWordIndex(Idx);
+	const uint64 Bit = GetBitMask(Idx);
+
+	int32 Count = 0;
+	for (int32 Plane = 0; Plane < NumCountPlanes; Plane++)
+	{
+		Count |= (NearbyCountPlanes[Plane][Word] & Bit) ? (1 << Plane) : 0;
+	}
+
+	return Count;
+}
+
+int32 FMinesweeperBitboard::GetWidth() const
+{
+	return Width;
+}
+
+int32 FMinesweeperBitboard::GetHeight() const
+{
+	return Height;
+}
+
+int32 FMinesweeperBitboard::Num() const
+{
+	return Width * Height;
+}
+
+SIZE_T FMinesweeperBitboard::GetAllocatedSize() const
+{
+	SIZE_T AllocatedSize = Mines.GetAllocatedSize() + Flags.GetAllocatedSize() + Activated.GetAllocatedSize()
+		+ CascadeMask.GetAllocatedSize() + CascadeFill.GetAllocatedSize();
+
+	for (const TArray<uint64>& CountPlane : NearbyCountPlanes)
+	{
+		AllocatedSize += CountPlane.GetAllocatedSize();
+	}
+
+	return AllocatedSize;
+}
+
+int32 FMinesweeperBitboard::GetWordIndex(int32 Idx) const
+{
+	return (Idx / Width) * WordsPerRow + (Idx % Width) / 64;
+}
+
+uint64 FMinesweeperBitboard::GetBitMask(int32 Idx) const
+{
+	return uint64(1) << ((Idx % Width) % 64);
+}
+
+uint64 FMinesweeperBitboard::GetValidMask(int32 Word) const
+{
+	const int32 ValidBits = Width - Word * 64;
+	return ValidBits >= 64 ? ~uint64(0) : (uint64(1) << ValidBits) - 1;
+}
+
+uint64 FMinesweeperBitboard::ShiftFromLeft(const uint64* Row, int32 Word)
+{
+	// Every cell takes the value of the cell to its left, which is the bit below it
+	return (Row[Word] << 1) | (Word > 0 ? Row[Word - 1] >> 63 : 0);
+}
+
+uint64 FMinesweeperBitboard::ShiftFromRight(const uint64* Row, int32 Word, int32 WordsInRow)
+{
+	// Every cell takes the value of the cell to its right, which is the bit above it
+	return (Row[Word] >> 1) | (Word < WordsInRow - 1 ? Row[Word + 1] << 63 : 0);
+}
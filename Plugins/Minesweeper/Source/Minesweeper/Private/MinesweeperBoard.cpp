@@ -0,0 +1,654 @@
+﻿#include "MinesweeperBoard.h"
+
+#include "Minesweeper.h"
+#include "MinesweeperStats.h"
+
+FMinesweeperBoard::FMinesweeperBoard()
+	: Width(0)
+	, Height(0)
+	, MinesCount(0)
+	, bCanPlay(false)
+	, NumRevealedSafeCells(0)
+	, NumFlags(0)
+	, NumAppliedJournalEntries(0)
+	, ReportedAllocatedSize(0)
+{
+}
+
+FMinesweeperBoard::~FMinesweeperBoard()
+{
+	DEC_MEMORY_STAT_BY(STAT_MinesweeperBoardMemory, ReportedAllocatedSize);
+}
+
+int32 FMinesweeperBoard::GenerateMinesData(int32 InWidth, int32 InHeight, int32 InMinesCount, uint64 InSeed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperGenerateMinesData);
+
+	Width = InWidth;
+	Height = InHeight;
+	MinesCount = InMinesCount;
+	bCanPlay = true;
+	NumRevealedSafeCells = 0;
+	NumFlags = 0;
+	RandomStream.Initialize(InSeed);
+	ClearJournal();
+
+	const int32 NumCells = Height * Width;
+	check(MinesCount < NumCells);
+
+	// Reset rather than Empty, so that a board of the same size or smaller reuses its allocation
+	MinesData.Reset();
+	MinesData.SetNumZeroed(NumCells);
+
+	// Here's the algorithm we've come up with for mine placement
+	// 1. Store Cell data in a row-major ordered array
+	// 2. Use Floyd's sampling to choose which cells become mines. For each J in [NumCells - MinesCount, NumCells)
+	//    we pick a random cell in [0, J]. If it's already a mine, then J itself becomes the mine instead, which is never
+	//    a mine yet as it's outside of the range of any earlier pick.
+	//    This chooses every set of cells with equal probability, in O(MinesCount) time, and uses the board itself
+	//    to know which cells have been chosen so it doesn't need any extra memory.
+	// 3. If we still have any clean cells left over,
+	//    return a random clean cell so that we can provide a player hint if enabled.
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_PlaceMines);
+
+		for (int32 J = NumCells - MinesCount; J < NumCells; J++)
+		{
+			int32 MineIndex = RandomStream.RandRange(0, J);
+			if (MinesData[MineIndex].IsMine())
+			{
+				MineIndex = J;
+			}
+
+			MinesData[MineIndex].SetMine();
+		}
+	}
+
+	ComputeNearbyMinesCounts();
+	UpdateMemoryStats();
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_BroadcastBoardChanged);
+		BoardChangedEvent.Broadcast();
+	}
+
+	// We'll return a starting point that can be used to give the initial mine hint to a player, if we can.
+	// If the entire grid is mines, we can't.
+	// Picking random cells until we find a clean one keeps every clean cell equally likely, and as at least 3 cells are
+	// always left clean this takes NumCells / (NumCells - MinesCount) picks on average.
+	if (MinesCount < NumCells)
+	{
+		int32 StartingPoint = RandomStream.RandRange(0, NumCells - 1);
+		while (MinesData[StartingPoint].IsMine())
+		{
+			StartingPoint = RandomStream.RandRange(0, NumCells - 1);
+		}
+
+		return StartingPoint;
+	}
+
+	return -1;
+}
+
+void FMinesweeperBoard::ComputeNearbyMinesCounts()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperCountNearbyMines);
+
+	// The 3x3 neighbourhood sum is separable, so rather than walking 9 cells for each cell we:
+	// 1. Sum each row horizontally (left + self + right) into a rolling buffer of 3 rows
+	// 2. Add the horizontal sums of the row above, this row and the row below together
+	// 3. Subtract the cell itself, as a cell doesn't count towards its own nearby mines
+	// This touches every cell a constant number of times, and only needs 3 rows of scratch space.
+	HorizontalSums.Reset();
+	HorizontalSums.SetNumZeroed(Width * 3);
+
+	auto SumRow = [this](int32 Row)
+	{
+		uint8* Sums = &HorizontalSums[(Row % 3) * Width];
+		const FCellData* RowData = &MinesData[Row * Width];
+
+		for (int32 Col = 0; Col < Width; Col++)
+		{
+			Sums[Col] = (Col > 0 ? RowData[Col - 1].IsMine() : 0) + RowData[Col].IsMine() + (Col < Width - 1 ? RowData[Col + 1].IsMine() : 0);
+		}
+	};
+
+	SumRow(0);
+	if (Height > 1)
+	{
+		SumRow(1);
+	}
+
+	for (int32 Row = 0; Row < Height; Row++)
+	{
+		const uint8* Above = Row > 0 ? &HorizontalSums[((Row - 1) % 3) * Width] : nullptr;
+		const uint8* Current = &HorizontalSums[(Row % 3) * Width];
+		const uint8* Below = Row < Height - 1 ? &HorizontalSums[((Row + 1) % 3) * Width] : nullptr;
+		FCellData* RowData = &MinesData[Row * Width];
+
+		for (int32 Col = 0; Col < Width; Col++)
+		{
+			const int32 Sum = (Above ? Above[Col] : 0) + Current[Col] + (Below ? Below[Col] : 0);
+			RowData[Col].SetNearbyMinesCount(Sum - RowData[Col].IsMine());
+		}
+
+		// The row above is no longer needed, so its slot is reused for the row after next
+		if (Row + 2 < Height)
+		{
+			SumRow(Row + 2);
+		}
+	}
+}
+
+void FMinesweeperBoard::ActivateNearbyCells(int32 CellIndex)
+{
+	check(CellIndex < MinesData.Num())
+
+	for (int32 i = -1; i < 2; i++)
+	{
+		for (int32 j = -1; j < 2; j++)
+		{
+			int32 AdjacentCellIndex = -1;
+			if (TryGetAdjacentCellIndex(CellIndex, i, j, AdjacentCellIndex))
+			{
+				FCellData* AdjacentCell = &MinesData[AdjacentCellIndex];
+				if (!AdjacentCell->IsMine() && !AdjacentCell->IsFlagged() && !AdjacentCell->WasActivated())
+				{
+					// Mark the cell as activated as soon as it's queued, so it can never be queued twice
+					AdjacentCell->SetActivated();
+					RevealQueue.Add(AdjacentCellIndex);
+				}
+			}
+		}
+	}
+}
+
+bool FMinesweeperBoard::CanPlay() const
+{
+	return bCanPlay && NumRevealedSafeCells < GetNumSafeCells();
+}
+
+bool FMinesweeperBoard::HasWon() const
+{
+	// Cells can only be revealed while we're able to play, so this is reached by the very reveal that opens the last safe cell
+	return bCanPlay && MinesData.Num() > 0 && NumRevealedSafeCells == GetNumSafeCells();
+}
+
+bool FMinesweeperBoard::HasLost() const
+{
+	return !bCanPlay;
+}
+
+int32 FMinesweeperBoard::ApplyMoves(TArrayView<const FMinesweeperMove> Moves)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperApplyMoves);
+
+	// Every move adds the cells it changed to the worklist, so once we're done it holds every change in the batch
+	RevealQueue.Reset();
+
+	const bool bCouldPlay = CanPlay();
+	int32 NumRevealed = 0;
+	int32 NumApplied = 0;
+	int32 NumOutside = 0;
+
+	for (const FMinesweeperMove& Move : Moves)
+	{
+		if (!CanPlay())
+		{
+			break;
+		}
+
+		// Moves come from scripts and recordings as well as from clicks, so a bad one is skipped rather than trusted
+		if (!MinesData.IsValidIndex(Move.Idx))
+		{
+			NumOutside++;
+			continue;
+		}
+
+		switch (Move.Type)
+		{
+		case EMinesweeperMoveType::Reveal:
+			NumRevealed += RevealCell(Move.Idx);
+			break;
+
+		case EMinesweeperMoveType::Flag:
+			FlagCell(Move.Idx);
+			break;
+
+		case EMinesweeperMoveType::Chord:
+			NumRevealed += ChordCell(Move.Idx);
+			break;
+		}
+
+		NumApplied++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_MinesweeperMovesApplied, NumApplied);
+	INC_DWORD_STAT_BY(STAT_MinesweeperCellsRevealed, NumRevealed);
+
+	UE_CLOG(NumOutside > 0, LogMinesweeper, Warning, TEXT("Skipped %d moves to cells outside the %dx%d board"), NumOutside, Width, Height);
+
+	// The worklist only grows on the first large cascade of a board, and is kept from then on.
+	// The journal grows with every move, by the cells the move changed
+	UpdateMemoryStats();
+
+	if (bCouldPlay && !CanPlay())
+	{
+		// Ending the game, whether on a mine or on the last safe cell, changes how every cell is displayed, so this is a change to the whole board
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_BroadcastBoardChanged);
+		BoardChangedEvent.Broadcast();
+	}
+	else if (RevealQueue.Num() > 0)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_BroadcastCellsChanged);
+		CellsChangedEvent.Broadcast(RevealQueue);
+	}
+
+	return NumRevealed;
+}
+
+int32 FMinesweeperBoard::ActivateCell(int32 Idx)
+{
+	const FMinesweeperMove Move(EMinesweeperMoveType::Reveal, Idx);
+	return ApplyMoves(MakeArrayView(&Move, 1));
+}
+
+int32 FMinesweeperBoard::RevealCell(int32 Idx)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperActivateCell);
+
+	FCellData* Cell = &MinesData[Idx];
+
+	if (Cell->IsFlagged() || Cell->WasActivated())
+	{
+		return 0;
+	}
+
+	if (Cell->IsMine())
+	{
+		// We've hit a mine!
+		Detonate(Idx);
+		return 0;
+	}
+
+	const int32 FirstQueueIndex = RevealQueue.Num();
+	Cell->SetActivated();
+	RevealQueue.Add(Idx);
+
+	return Cascade(FirstQueueIndex);
+}
+
+int32 FMinesweeperBoard::ChordCell(int32 Idx)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperActivateCell);
+
+	const FCellData& Cell = MinesData[Idx];
+	if (!Cell.WasActivated() || Cell.GetNearbyMinesCount() == 0)
+	{
+		return 0;
+	}
+
+	// A chord only goes ahead once the player has flagged as many cells as the number says, and loses if one of those
+	// flags is wrong. As with a single reveal, hitting a mine ends the game without revealing anything else
+	int32 NumFlagged = 0;
+	int32 NumHidden = 0;
+	int32 HiddenMineIndex = INDEX_NONE;
+
+	for (int32 i = -1; i < 2; i++)
+	{
+		for (int32 j = -1; j < 2; j++)
+		{
+			int32 AdjacentCellIndex = -1;
+			if (TryGetAdjacentCellIndex(Idx, i, j, AdjacentCellIndex))
+			{
+				const FCellData& AdjacentCell = MinesData[AdjacentCellIndex];
+				if (AdjacentCell.IsFlagged())
+				{
+					NumFlagged++;
+				}
+				else if (!AdjacentCell.WasActivated())
+				{
+					NumHidden++;
+					HiddenMineIndex = AdjacentCell.IsMine() ? AdjacentCellIndex : HiddenMineIndex;
+				}
+			}
+		}
+	}
+
+	if (NumFlagged != Cell.GetNearbyMinesCount() || NumHidden == 0)
+	{
+		return 0;
+	}
+
+	if (HiddenMineIndex != INDEX_NONE)
+	{
+		Detonate(HiddenMineIndex);
+		return 0;
+	}
+
+	const int32 FirstQueueIndex = RevealQueue.Num();
+	ActivateNearbyCells(Idx);
+
+	return Cascade(FirstQueueIndex);
+}
+
+void FMinesweeperBoard::FlagCell(int32 Idx)
+{
+	FCellData* Cell = &MinesData[Idx];
+
+	// Revealed cells can't be flagged, which the board view shows by disabling them
+	if (Cell->WasActivated())
+	{
+		return;
+	}
+
+	Cell->SetIsFlagged(!Cell->IsFlagged());
+	NumFlags += Cell->IsFlagged() ? 1 : -1;
+	RevealQueue.Add(Idx);
+
+	RecordMove(EJournalAction::Flag, MakeArrayView(&Idx, 1));
+}
+
+int32 FMinesweeperBoard::Cascade(int32 FirstQueueIndex)
+{
+	// Cascade outward until we've found nearby mines
+	// This is a flood fill over an explicit worklist rather than recursion, so large open regions can't blow the stack.
+	// Every cell is activated before it's queued, which bounds the worklist by the board size and means
+	// each cell is only ever looked at once. The worklist is a member so its allocation is reused between reveals.
+	// We walk the worklist rather than popping from it, so once we're done it holds exactly the cells this move opened,
+	// after the cells changed by the moves before it in the batch
+	TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_Cascade);
+
+	for (int32 QueueIndex = FirstQueueIndex; QueueIndex < RevealQueue.Num(); QueueIndex++)
+	{
+		const int32 CurrentIndex = RevealQueue[QueueIndex];
+
+		if (MinesData[CurrentIndex].GetNearbyMinesCount() == 0)
+		{
+			ActivateNearbyCells(CurrentIndex);
+		}
+	}
+
+	const int32 NumOpened = RevealQueue.Num() - FirstQueueIndex;
+	NumRevealedSafeCells += NumOpened;
+	SET_DWORD_STAT(STAT_MinesweeperLastCascadeSize, NumOpened);
+
+	RecordMove(EJournalAction::Reveal, MakeArrayView(RevealQueue.GetData() + FirstQueueIndex, NumOpened));
+
+	return NumOpened;
+}
+
+void FMinesweeperBoard::Detonate(int32 Idx)
+{
+	bCanPlay = false;
+	RecordMove(EJournalAction::Detonate, MakeArrayView(&Idx, 1));
+}
+
+void FMinesweeperBoard::RevealAll()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperBoard::RevealAll);
+
+	// Counts are already known, so revealing is just a matter of flipping the activated state.
+	// Flags are cleared along the way, as a revealed cell can't be flagged
+	for (FCellData& Cell : MinesData)
+	{
+		Cell.SetIsFlagged(false);
+		Cell.SetActivated();
+	}
+
+	// Showing the whole board gives the game up rather than winning it, so it ends the game the same way a mine does
+	bCanPlay = false;
+	NumRevealedSafeCells = GetNumSafeCells();
+	NumFlags = 0;
+
+	// Every cell is shown, so the moves that led here no longer mean anything
+	ClearJournal();
+
+	BoardChangedEvent.Broadcast();
+}
+
+void FMinesweeperBoard::ToggleFlag(int32 Idx)
+{
+	const FMinesweeperMove Move(EMinesweeperMoveType::Flag, Idx);
+	ApplyMoves(MakeArrayView(&Move, 1));
+}
+
+bool FMinesweeperBoard::Undo()
+{
+	if (!CanUndo())
+	{
+		return false;
+	}
+
+	NumAppliedJournalEntries--;
+	ApplyJournalEntry(Journal[NumAppliedJournalEntries], false);
+	return true;
+}
+
+bool FMinesweeperBoard::Redo()
+{
+	if (!CanRedo())
+	{
+		return false;
+	}
+
+	NumAppliedJournalEntries++;
+	ApplyJournalEntry(Journal[NumAppliedJournalEntries - 1], true);
+	return true;
+}
+
+bool FMinesweeperBoard::CanUndo() const
+{
+	return NumAppliedJournalEntries > 0;
+}
+
+bool FMinesweeperBoard::CanRedo() const
+{
+	return NumAppliedJournalEntries < Journal.Num();
+}
+
+void FMinesweeperBoard::RecordMove(EJournalAction Action, TArrayView<const int32> Cells)
+{
+	// Shrinking doesn't free anything, so undoing and making new moves keeps reusing the same allocations
+	const int32 NumUsedCells = NumAppliedJournalEntries > 0 ? Journal[NumAppliedJournalEntries - 1].FirstCell + Journal[NumAppliedJournalEntries - 1].NumCells : 0;
+	Journal.SetNum(NumAppliedJournalEntries, false);
+	JournalCells.SetNum(NumUsedCells, false);
+
+	FJournalEntry& Entry = Journal.AddDefaulted_GetRef();
+	Entry.Action = Action;
+	Entry.FirstCell = JournalCells.Num();
+	Entry.NumCells = Cells.Num();
+	JournalCells.Append(Cells.GetData(), Cells.Num());
+
+	NumAppliedJournalEntries = Journal.Num();
+}
+
+void FMinesweeperBoard::ApplyJournalEntry(const FJournalEntry& Entry, bool bForwards)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperBoard::ApplyJournalEntry);
+
+	const TArrayView<const int32> Cells = MakeArrayView(JournalCells.GetData() + Entry.FirstCell, Entry.NumCells);
+
+	switch (Entry.Action)
+	{
+	case EJournalAction::Reveal:
+	{
+		const bool bCouldPlay = CanPlay();
+
+		// Cells revealed by a move were all hidden before it, so the move is undone by hiding exactly those cells again
+		for (const int32 Idx : Cells)
+		{
+			if (bForwards)
+			{
+				MinesData[Idx].SetActivated();
+			}
+			else
+			{
+				MinesData[Idx].ClearActivated();
+			}
+		}
+
+		NumRevealedSafeCells += bForwards ? Cells.Num() : -Cells.Num();
+
+		// Taking back or making again the move that won the game changes how every cell is displayed
+		if (bCouldPlay != CanPlay())
+		{
+			BoardChangedEvent.Broadcast();
+		}
+		else
+		{
+			CellsChangedEvent.Broadcast(Cells);
+		}
+		break;
+	}
+
+	case EJournalAction::Flag:
+		MinesData[Cells[0]].SetIsFlagged(!MinesData[Cells[0]].IsFlagged());
+		NumFlags += MinesData[Cells[0]].IsFlagged() ? 1 : -1;
+		CellsChangedEvent.Broadcast(Cells);
+		break;
+
+	case EJournalAction::Detonate:
+		// The mine itself was never revealed, only the game ended, so that's all there is to take back
+		bCanPlay = !bForwards;
+		BoardChangedEvent.Broadcast();
+		break;
+	}
+}
+
+void FMinesweeperBoard::ClearJournal()
+{
+	Journal.Reset();
+	JournalCells.Reset();
+	NumAppliedJournalEntries = 0;
+}
+
+void FMinesweeperBoard::SwapBoard(FMinesweeperBoard& Other)
+{
+	// Arrays are swapped by pointer, so this doesn't depend on the size of either board
+	Swap(Width, Other.Width);
+	Swap(Height, Other.Height);
+	Swap(MinesCount, Other.MinesCount);
+	Swap(bCanPlay, Other.bCanPlay);
+	Swap(NumRevealedSafeCells, Other.NumRevealedSafeCells);
+	Swap(NumFlags, Other.NumFlags);
+	Swap(RandomStream, Other.RandomStream);
+	Swap(MinesData, Other.MinesData);
+	Swap(RevealQueue, Other.RevealQueue);
+	Swap(HorizontalSums, Other.HorizontalSums);
+	Swap(Journal, Other.Journal);
+	Swap(JournalCells, Other.JournalCells);
+	Swap(NumAppliedJournalEntries, Other.NumAppliedJournalEntries);
+
+	UpdateMemoryStats();
+	Other.UpdateMemoryStats();
+
+	BoardChangedEvent.Broadcast();
+	Other.BoardChangedEvent.Broadcast();
+}
+
+bool FMinesweeperBoard::TryGetAdjacentCellIndex(int32 CellIndex, int32 Row, int32 Col, int32& OutIndex) const
+{
+	// Reset out index as the first thing, so it's not forgotten or if code changes, it's guaranteed to be set
+	// by this function
+	OutIndex = -1;
+
+	// Cells don't store their position, so derive it from the index and bounds check the adjacent row,col directly.
+	// This also makes sure we can't wrap around to the other side of the board.
+	const int32 AdjacentRow = GetRow(CellIndex) + Row;
+	const int32 AdjacentCol = GetCol(CellIndex) + Col;
+
+	if (AdjacentRow < 0 || AdjacentRow >= Height || AdjacentCol < 0 || AdjacentCol >= Width)
+	{
+		return false;
+	}
+
+	OutIndex = GetIndex(AdjacentRow, AdjacentCol);
+	return true;
+}
+
+int32 FMinesweeperBoard::GetWidth() const
+{
+	return Width;
+}
+
+int32 FMinesweeperBoard::GetHeight() const
+{
+	return Height;
+}
+
+int32 FMinesweeperBoard::GetMinesCount() const
+{
+	return MinesCount;
+}
+
+int32 FMinesweeperBoard::GetNumSafeCells() const
+{
+	return MinesData.Num() - MinesCount;
+}
+
+int32 FMinesweeperBoard::GetNumRevealedSafeCells() const
+{
+	return NumRevealedSafeCells;
+}
+
+int32 FMinesweeperBoard::GetNumFlags() const
+{
+	return NumFlags;
+}
+
+int32 FMinesweeperBoard::GetNumMinesRemaining() const
+{
+	return MinesCount - NumFlags;
+}
+
+uint64 FMinesweeperBoard::GetSeed() const
+{
+	return RandomStream.GetInitialSeed();
+}
+
+int32 FMinesweeperBoard::Num() const
+{
+	return MinesData.Num();
+}
+
+SIZE_T FMinesweeperBoard::GetAllocatedSize() const
+{
+	return MinesData.GetAllocatedSize() + RevealQueue.GetAllocatedSize() + HorizontalSums.GetAllocatedSize()
+		+ Journal.GetAllocatedSize() + JournalCells.GetAllocatedSize();
+}
+
+void FMinesweeperBoard::UpdateMemoryStats()
+{
+#if STATS
+	const SIZE_T AllocatedSize = GetAllocatedSize();
+	if (AllocatedSize != ReportedAllocatedSize)
+	{
+		DEC_MEMORY_STAT_BY(STAT_MinesweeperBoardMemory, ReportedAllocatedSize);
+		INC_MEMORY_STAT_BY(STAT_MinesweeperBoardMemory, AllocatedSize);
+		ReportedAllocatedSize = AllocatedSize;
+	}
+#endif
+}
+
+const FCellData& FMinesweeperBoard::GetCell(int32 Idx) const
+{
+	check(Idx < MinesData.Num())
+
+	return MinesData[Idx];
+}
+
+int32 FMinesweeperBoard::GetRow(int32 Idx) const
+{
+	return Idx / Width;
+}
+
+int32 FMinesweeperBoard::GetCol(int32 Idx) const
+{
+	return Idx % Width;
+}
+
+int32 FMinesweeperBoard::GetIndex(int32 Row, int32 Col) const
+{
+	return Row * Width + Col;
+}
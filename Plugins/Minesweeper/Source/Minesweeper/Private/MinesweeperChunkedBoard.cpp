@@ -0,0 +1,562 @@
+﻿#include "MinesweeperChunkedBoard.h"
+
+#include "MinesweeperStats.h"
+
+// Untouched chunks kept around by default, which is 1MB of cells
+#define DEFAULT_MAX_CACHED_CHUNKS 256
+
+/* Returns A * B / C rounded down, without overflowing when A * B doesn't fit in 64 bits
+ * The result must fit in 64 bits, and C must be less than 2^63
+ */
+static uint64 MultiplyDivide(uint64 A, uint64 B, uint64 C)
+{
+	// 128-bit product, built from 32-bit halves
+	const uint64 ALo = A & 0xFFFFFFFFull;
+	const uint64 AHi = A >> 32;
+	const uint64 BLo = B & 0xFFFFFFFFull;
+	const uint64 BHi = B >> 32;
+
+	const uint64 LoLo = ALo * BLo;
+	const uint64 HiLo = AHi * BLo;
+	const uint64 Cross = (LoLo >> 32) + (HiLo & 0xFFFFFFFFull) + ALo * BHi;
+
+	const uint64 ProductLo = (Cross << 32) | (LoLo & 0xFFFFFFFFull);
+	const uint64 ProductHi = AHi * BHi + (HiLo >> 32) + (Cross >> 32);
+
+	// Long division, one bit at a time. This only runs when a chunk is generated, so it doesn't need to be clever
+	uint64 Quotient = 0;
+	uint64 Remainder = 0;
+	for (int32 Bit = 127; Bit >= 0; Bit--)
+	{
+		const uint64 NextBit = Bit >= 64 ? (ProductHi >> (Bit - 64)) & 1 : (ProductLo >> Bit) & 1;
+		Remainder = (Remainder << 1) | NextBit;
+		Quotient <<= 1;
+
+		if (Remainder >= C)
+		{
+			Remainder -= C;
+			Quotient |= 1;
+		}
+	}
+
+	return Quotient;
+}
+
+FMinesweeperChunkedBoard::FMinesweeperChunkedBoard()
+	: Width(0)
+	, Height(0)
+	, MinesCount(0)
+	, bCanPlay(false)
+	, NumRevealedSafeCells(0)
+	, NumFlags(0)
+	, bInfinite(false)
+	, MineThreshold(0)
+	, MaxCachedChunks(DEFAULT_MAX_CACHED_CHUNKS)
+	, UseCounter(0)
+	, LastChunkCoord(FIntPoint::NoneValue)
+	, LastChunk(nullptr)
+	, ReportedAllocatedSize(0)
+{
+}
+
+FMinesweeperChunkedBoard::~FMinesweeperChunkedBoard()
+{
+	DEC_MEMORY_STAT_BY(STAT_MinesweeperBoardMemory, ReportedAllocatedSize);
+}
+
+FIntPoint FMinesweeperChunkedBoard::GenerateMinesData(int32 InWidth, int32 InHeight, int64 InMinesCount, uint64 InSeed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperGenerateMinesData);
+
+	ResetBoard(InWidth, InHeight, InSeed);
+	MinesCount = InMinesCount;
+	bInfinite = false;
+
+	check(MinesCount < Num());
+
+	BoardChangedEvent.Broadcast();
+
+	if (MinesCount < Num())
+	{
+		return FindStartingPoint(FIntPoint(0, 0), FIntPoint(Width - 1, Height - 1));
+	}
+
+	return FIntPoint::NoneValue;
+}
+
+FIntPoint FMinesweeperChunkedBoard::GenerateInfiniteMinesData(double InMineDensity, uint64 InSeed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperGenerateMinesData);
+
+	check(InMineDensity >= 0.0 && InMineDensity < 1.0)
+
+	const double MineDensity = FMath::Max(InMineDensity, MinInfiniteMineDensity);
+
+	ResetBoard(InfiniteSize, InfiniteSize, InSeed);
+	MinesCount = INDEX_NONE;
+	bInfinite = true;
+
+	// 2^64 as a double, so the threshold is the density as a fraction of every value the hash can take
+	MineThreshold = static_cast<uint64>(MineDensity * 18446744073709551616.0);
+
+	BoardChangedEvent.Broadcast();
+
+	// The hint is in the chunk in the middle of the board, so there's room to play in every direction
+	const int32 Middle = InfiniteSize / 2;
+	return FindStartingPoint(FIntPoint(Middle, Middle), FIntPoint(Middle + ChunkSize - 1, Middle + ChunkSize - 1));
+}
+
+void FMinesweeperChunkedBoard::ResetBoard(int32 InWidth, int32 InHeight, uint64 InSeed)
+{
+	Width = InWidth;
+	Height = InHeight;
+	bCanPlay = true;
+	NumRevealedSafeCells = 0;
+	NumFlags = 0;
+	RandomStream.Initialize(InSeed);
+
+	// Nothing is generated up front, chunks are made as they're looked at
+	Chunks.Reset();
+	CachedChunks.Reset();
+	LastChunkCoord = FIntPoint::NoneValue;
+	LastChunk = nullptr;
+
+	UpdateMemoryStats();
+}
+
+FIntPoint FMinesweeperChunkedBoard::FindStartingPoint(const FIntPoint& Min, const FIntPoint& Max)
+{
+	// Just like FMinesweeperBoard, we pick random cells until we find a clean one for the player hint.
+	// Only the chunk holding the cell we picked needs to be generated to know whether it's a mine.
+	FIntPoint StartingPoint;
+	do
+	{
+		StartingPoint = FIntPoint(RandomStream.RandRange(Min.X, Max.X), RandomStream.RandRange(Min.Y, Max.Y));
+	}
+	while (GetCell(StartingPoint).IsMine());
+
+	return StartingPoint;
+}
+
+bool FMinesweeperChunkedBoard::IsInfiniteMine(int32 X, int32 Y) const
+{
+	// This is the SplitMix64 output for the cell's position in row-major order, as if the seed's stream had been
+	// advanced that far, so every cell gets its own independent value without anything being stored
+	const uint64 CellKey = (uint64(uint32(Y)) << 32) | uint32(X);
+	return FMinesweeperRandomStream::Mix(RandomStream.GetInitialSeed() + (CellKey + 1) * 0x9E3779B97F4A7C15ull) < MineThreshold;
+}
+
+FIntPoint FMinesweeperChunkedBoard::GetChunkCellsSize(const FIntPoint& ChunkCoord) const
+{
+	return FIntPoint(
+		FMath::Min(ChunkSize, Width - ChunkCoord.X * ChunkSize),
+		FMath::Min(ChunkSize, Height - ChunkCoord.Y * ChunkSize)
+	);
+}
+
+int64 FMinesweeperChunkedBoard::GetChunkMinesCount(const FIntPoint& ChunkCoord) const
+{
+	// Taking every chunk in row-major order, the chunks before this one hold CellsBefore cells, and are given
+	// MinesCount * CellsBefore / NumCells mines rounded down. This chunk gets the difference between that and the same
+	// total including its own cells. Every chunk gets its fair share, and the shares always add up to exactly MinesCount.
+	// Every chunk row above is a full ChunkSize cells high, and every chunk to the left on this row is a full ChunkSize wide.
+	const FIntPoint ChunkCellsSize = GetChunkCellsSize(ChunkCoord);
+	const int64 CellsBefore = int64(ChunkCoord.Y) * ChunkSize * Width + int64(ChunkCellsSize.Y) * ChunkSize * ChunkCoord.X;
+	const int64 CellsAfter = CellsBefore + int64(ChunkCellsSize.X) * ChunkCellsSize.Y;
+
+	const uint64 NumCells = static_cast<uint64>(Num());
+	return static_cast<int64>(MultiplyDivide(MinesCount, CellsAfter, NumCells) - MultiplyDivide(MinesCount, CellsBefore, NumCells));
+}
+
+void FMinesweeperChunkedBoard::PlaceChunkMines(const FIntPoint& ChunkCoord, uint8* OutMines, int32 Stride) const
+{
+	const FIntPoint ChunkCellsSize = GetChunkCellsSize(ChunkCoord);
+	const int32 NumChunkCells = ChunkCellsSize.X * ChunkCellsSize.Y;
+	const int32 ChunkMinesCount = static_cast<int32>(GetChunkMinesCount(ChunkCoord));
+
+	// Each chunk has its own stream so it can be generated on its own, in any order, and always comes out the same
+	const uint64 ChunkKey = (uint64(uint32(ChunkCoord.X)) << 32) | uint32(ChunkCoord.Y);
+	FMinesweeperRandomStream ChunkStream(RandomStream.GetInitialSeed() ^ (ChunkKey * 0x9E3779B97F4A7C15ull));
+
+	// Floyd's sampling over the chunk's cells, as in FMinesweeperBoard::GenerateMinesData
+	for (int32 J = NumChunkCells - ChunkMinesCount; J < NumChunkCells; J++)
+	{
+		int32 MineIndex = ChunkStream.RandRange(0, J);
+		uint8* Mine = &OutMines[(MineIndex / ChunkCellsSize.X) * Stride + MineIndex % ChunkCellsSize.X];
+		if (*Mine)
+		{
+			Mine = &OutMines[(J / ChunkCellsSize.X) * Stride + J % ChunkCellsSize.X];
+		}
+
+		*Mine = 1;
+	}
+}
+
+void FMinesweeperChunkedBoard::GenerateChunk(const FIntPoint& ChunkCoord, FChunk& Chunk) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperGenerateChunk);
+
+	// Cells along the edges of the chunk have neighbours in the chunks around it, so we place the mines of all
+	// 3x3 chunks into one scratch grid. Chunks beyond the edges of the board just stay empty.
+	const int32 ScratchStride = ChunkSize * 3;
+	MinesScratch.Reset();
+	MinesScratch.SetNumZeroed(ScratchStride * ScratchStride);
+
+	if (bInfinite)
+	{
+		// Every cell can be asked on its own whether it's a mine, so we only hash the chunk and the ring of cells around it
+		const FIntPoint ChunkOrigin = ChunkCoord * ChunkSize;
+		for (int32 Row = -1; Row <= ChunkSize; Row++)
+		{
+			for (int32 Col = -1; Col <= ChunkSize; Col++)
+			{
+				const FIntPoint Cell(ChunkOrigin.X + Col, ChunkOrigin.Y + Row);
+				MinesScratch[(ChunkSize + Row) * ScratchStride + ChunkSize + Col] = IsValidCell(Cell) && IsInfiniteMine(Cell.X, Cell.Y);
+			}
+		}
+	}
+	else
+	{
+		const FIntPoint NumChunks(FMath::DivideAndRoundUp(Width, ChunkSize), FMath::DivideAndRoundUp(Height, ChunkSize));
+		for (int32 OffsetY = -1; OffsetY <= 1; OffsetY++)
+		{
+			for (int32 OffsetX = -1; OffsetX <= 1; OffsetX++)
+			{
+				const FIntPoint NeighbourCoord(ChunkCoord.X + OffsetX, ChunkCoord.Y + OffsetY);
+				if (NeighbourCoord.X >= 0 && NeighbourCoord.X < NumChunks.X && NeighbourCoord.Y >= 0 && NeighbourCoord.Y < NumChunks.Y)
+				{
+					PlaceChunkMines(NeighbourCoord, &MinesScratch[(OffsetY + 1) * ChunkSize * ScratchStride + (OffsetX + 1) * ChunkSize], ScratchStride);
+				}
+			}
+		}
+	}
+
+	Chunk.Cells.Reset();
+	Chunk.Cells.SetNumZeroed(ChunkSize * ChunkSize);
+	Chunk.bTouched = false;
+
+	// Cells past the edge of the board are never mines, so they count as empty neighbours
+	const FIntPoint ChunkCellsSize = GetChunkCellsSize(ChunkCoord);
+	for (int32 Row = 0; Row < ChunkCellsSize.Y; Row++)
+	{
+		const uint8* Above = &MinesScratch[(ChunkSize + Row - 1) * ScratchStride + ChunkSize];
+		const uint8* Current = Above + ScratchStride;
+		const uint8* Below = Current + ScratchStride;
+		FCellData* RowData = &Chunk.Cells[Row * ChunkSize];
+
+		for (int32 Col = 0; Col < ChunkCellsSize.X; Col++)
+		{
+			const int32 Sum =
+				Above[Col - 1] + Above[Col] + Above[Col + 1] +
+				Current[Col - 1] + Current[Col + 1] +
+				Below[Col - 1] + Below[Col] + Below[Col + 1];
+
+			if (Current[Col])
+			{
+				RowData[Col].SetMine();
+			}
+			RowData[Col].SetNearbyMinesCount(Sum);
+		}
+	}
+}
+
+FMinesweeperChunkedBoard::FChunk& FMinesweeperChunkedBoard::FindOrGenerateChunk(const FIntPoint& ChunkCoord) const
+{
+	if (LastChunk != nullptr && LastChunkCoord == ChunkCoord)
+	{
+		LastChunk->LastUsed = ++UseCounter;
+		return *LastChunk;
+	}
+
+	TUniquePtr<FChunk>* ExistingChunk = Chunks.Find(ChunkCoord);
+	if (ExistingChunk != nullptr)
+	{
+		LastChunkCoord = ChunkCoord;
+		LastChunk = ExistingChunk->Get();
+		LastChunk->LastUsed = ++UseCounter;
+		return *LastChunk;
+	}
+
+	// Once the cache is full we evict the least recently used untouched chunk, and reuse its allocation for the new one.
+	// CachedChunks is bounded by MaxCachedChunks, so looking for it is cheap next to generating a chunk.
+	TUniquePtr<FChunk> NewChunk;
+	bool bAllocatedChunk = false;
+	if (CachedChunks.Num() >= MaxCachedChunks && CachedChunks.Num() > 0)
+	{
+		int32 EvictIndex = 0;
+		for (int32 Index = 1; Index < CachedChunks.Num(); Index++)
+		{
+			if (Chunks[CachedChunks[Index]]->LastUsed < Chunks[CachedChunks[EvictIndex]]->LastUsed)
+			{
+				EvictIndex = Index;
+			}
+		}
+
+		Chunks.RemoveAndCopyValue(CachedChunks[EvictIndex], NewChunk);
+		CachedChunks.RemoveAtSwap(EvictIndex);
+	}
+	else
+	{
+		NewChunk = MakeUnique<FChunk>();
+		bAllocatedChunk = true;
+	}
+
+	GenerateChunk(ChunkCoord, *NewChunk);
+
+	LastChunkCoord = ChunkCoord;
+	LastChunk = NewChunk.Get();
+	LastChunk->LastUsed = ++UseCounter;
+
+	Chunks.Add(ChunkCoord, MoveTemp(NewChunk));
+	CachedChunks.Add(ChunkCoord);
+
+	// A chunk that replaced an evicted one reused its memory, so only new chunks change how much we hold
+	if (bAllocatedChunk)
+	{
+		UpdateMemoryStats();
+	}
+
+	return *LastChunk;
+}
+
+FCellData FMinesweeperChunkedBoard::GetCell(const FIntPoint& Cell) const
+{
+	check(IsValidCell(Cell))
+
+	const FChunk& Chunk = FindOrGenerateChunk(FIntPoint(Cell.X / ChunkSize, Cell.Y / ChunkSize));
+	return Chunk.Cells[(Cell.Y % ChunkSize) * ChunkSize + Cell.X % ChunkSize];
+}
+
+FCellData& FMinesweeperChunkedBoard::GetMutableCell(const FIntPoint& Cell)
+{
+	check(IsValidCell(Cell))
+
+	const FIntPoint ChunkCoord(Cell.X / ChunkSize, Cell.Y / ChunkSize);
+	FChunk& Chunk = FindOrGenerateChunk(ChunkCoord);
+
+	// The player's changes can't be regenerated, so this chunk has to stay in memory from now on
+	if (!Chunk.bTouched)
+	{
+		Chunk.bTouched = true;
+		CachedChunks.RemoveSwap(ChunkCoord);
+	}
+
+	return Chunk.Cells[(Cell.Y % ChunkSize) * ChunkSize + Cell.X % ChunkSize];
+}
+
+void FMinesweeperChunkedBoard::ActivateNearbyCells(const FIntPoint& Cell)
+{
+	for (int32 i = -1; i < 2; i++)
+	{
+		for (int32 j = -1; j < 2; j++)
+		{
+			const FIntPoint AdjacentCellPosition(Cell.X + j, Cell.Y + i);
+			if (!IsValidCell(AdjacentCellPosition))
+			{
+				continue;
+			}
+
+			// Only cells we're going to activate are fetched as mutable, so looking at neighbours doesn't pin their chunks
+			const FCellData AdjacentCell = GetCell(AdjacentCellPosition);
+			if (!AdjacentCell.IsMine() && !AdjacentCell.IsFlagged() && !AdjacentCell.WasActivated())
+			{
+				// Mark the cell as activated as soon as it's queued, so it can never be queued twice
+				GetMutableCell(AdjacentCellPosition).SetActivated();
+				RevealQueue.Add(AdjacentCellPosition);
+			}
+		}
+	}
+}
+
+bool FMinesweeperChunkedBoard::CanPlay() const
+{
+	return bCanPlay && !HasWon();
+}
+
+bool FMinesweeperChunkedBoard::HasWon() const
+{
+	return bCanPlay && !bInfinite && Num() > 0 && NumRevealedSafeCells == GetNumSafeCells();
+}
+
+bool FMinesweeperChunkedBoard::HasLost() const
+{
+	return !bCanPlay;
+}
+
+int32 FMinesweeperChunkedBoard::ActivateCell(const FIntPoint& Cell)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperActivateCell);
+
+	if (!CanPlay())
+	{
+		return 0;
+	}
+
+	const FCellData CellData = GetCell(Cell);
+
+	if (CellData.IsFlagged() || CellData.WasActivated())
+	{
+		return 0;
+	}
+
+	if (CellData.IsMine())
+	{
+		// We've hit a mine!
+		// Ending the game changes how every cell is displayed, so this is a change to the whole board
+		bCanPlay = false;
+		BoardChangedEvent.Broadcast();
+		return 0;
+	}
+
+	// The same worklist flood fill as FMinesweeperBoard::ActivateCell, see there for the details
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_Cascade);
+
+		RevealQueue.Reset();
+
+		GetMutableCell(Cell).SetActivated();
+		RevealQueue.Add(Cell);
+
+		for (int32 QueueIndex = 0; QueueIndex < RevealQueue.Num(); QueueIndex++)
+		{
+			const FIntPoint CurrentCell = RevealQueue[QueueIndex];
+
+			if (GetCell(CurrentCell).GetNearbyMinesCount() == 0)
+			{
+				ActivateNearbyCells(CurrentCell);
+			}
+		}
+	}
+
+	NumRevealedSafeCells += RevealQueue.Num();
+
+	SET_DWORD_STAT(STAT_MinesweeperLastCascadeSize, RevealQueue.Num());
+	INC_DWORD_STAT_BY(STAT_MinesweeperCellsRevealed, RevealQueue.Num());
+	UpdateMemoryStats();
+
+	if (HasWon())
+	{
+		// Opening the last safe cell ends the game just like hitting a mine does
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_BroadcastBoardChanged);
+		BoardChangedEvent.Broadcast();
+	}
+	else
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(Minesweeper_BroadcastCellsChanged);
+		CellsChangedEvent.Broadcast(RevealQueue);
+	}
+
+	return RevealQueue.Num();
+}
+
+void FMinesweeperChunkedBoard::ToggleFlag(const FIntPoint& Cell)
+{
+	// Revealed cells can't be flagged. Checked before fetching the cell as mutable, so the chunk isn't pinned for nothing
+	if (GetCell(Cell).WasActivated())
+	{
+		return;
+	}
+
+	FCellData& CellData = GetMutableCell(Cell);
+	CellData.SetIsFlagged(!CellData.IsFlagged());
+	NumFlags += CellData.IsFlagged() ? 1 : -1;
+
+	CellsChangedEvent.Broadcast(MakeArrayView(&Cell, 1));
+}
+
+int32 FMinesweeperChunkedBoard::GetWidth() const
+{
+	return Width;
+}
+
+int32 FMinesweeperChunkedBoard::GetHeight() const
+{
+	return Height;
+}
+
+int64 FMinesweeperChunkedBoard::GetMinesCount() const
+{
+	return MinesCount;
+}
+
+int64 FMinesweeperChunkedBoard::GetNumSafeCells() const
+{
+	return bInfinite ? INDEX_NONE : Num() - MinesCount;
+}
+
+int64 FMinesweeperChunkedBoard::GetNumRevealedSafeCells() const
+{
+	return NumRevealedSafeCells;
+}
+
+int64 FMinesweeperChunkedBoard::GetNumFlags() const
+{
+	return NumFlags;
+}
+
+int64 FMinesweeperChunkedBoard::GetNumMinesRemaining() const
+{
+	return bInfinite ? INDEX_NONE : MinesCount - NumFlags;
+}
+
+bool FMinesweeperChunkedBoard::IsInfinite() const
+{
+	return bInfinite;
+}
+
+uint64 FMinesweeperChunkedBoard::GetSeed() const
+{
+	return RandomStream.GetInitialSeed();
+}
+
+int64 FMinesweeperChunkedBoard::Num() const
+{
+	return int64(Width) * Height;
+}
+
+bool FMinesweeperChunkedBoard::IsValidCell(const FIntPoint& Cell) const
+{
+	return Cell.X >= 0 && Cell.X < Width && Cell.Y >= 0 && Cell.Y < Height;
+}
+
+void FMinesweeperChunkedBoard::SetMaxCachedChunks(int32 InMaxCachedChunks)
+{
+	// We always need room for the chunk that's being looked at
+	MaxCachedChunks = FMath::Max(InMaxCachedChunks, 1);
+}
+
+int32 FMinesweeperChunkedBoard::GetNumChunks() const
+{
+	return Chunks.Num();
+}
+
+int32 FMinesweeperChunkedBoard::GetNumCachedChunks() const
+{
+	return CachedChunks.Num();
+}
+
+SIZE_T FMinesweeperChunkedBoard::GetAllocatedSize() const
+{
+	SIZE_T AllocatedSize = Chunks.GetAllocatedSize() + CachedChunks.GetAllocatedSize() + MinesScratch.GetAllocatedSize() + RevealQueue.GetAllocatedSize();
+	for (const TPair<FIntPoint, TUniquePtr<FChunk>>& Pair : Chunks)
+	{
+		AllocatedSize += sizeof(FChunk) + Pair.Value->Cells.GetAllocatedSize();
+	}
+
+	return AllocatedSize;
+}
+
+void FMinesweeperChunkedBoard::UpdateMemoryStats() const
+{
+#if STATS
+	const SIZE_T AllocatedSize = GetAllocatedSize();
+	if (AllocatedSize != ReportedAllocatedSize)
+	{
+		DEC_MEMORY_STAT_BY(STAT_MinesweeperBoardMemory, ReportedAllocatedSize);
+		INC_MEMORY_STAT_BY(STAT_MinesweeperBoardMemory, AllocatedSize);
+		ReportedAllocatedSize = AllocatedSize;
+	}
+#endif
+}
+
+#undef DEFAULT_MAX_CACHED_CHUNKS
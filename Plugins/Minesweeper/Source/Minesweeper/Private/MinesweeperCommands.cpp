@@ -1,12 +1,12 @@
-// Copyright Epic Games, Inc. All Rights Reserved.
-
-#include "MinesweeperCommands.h"
-
-#define LOCTEXT_NAMESPACE "FMinesweeperModule"
-
-void FMinesweeperCommands::RegisterCommands()
-{
-	UI_COMMAND(OpenPluginWindow, "Minesweeper", "Bring up Minesweeper window", EUserInterfaceActionType::Button, FInputGesture());
-}
-
-#undef LOCTEXT_NAMESPACE
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MinesweeperCommands.h"
+
+#define LOCTEXT_NAMESPACE "FMinesweeperModule"
+
+void FMinesweeperCommands::RegisterCommands()
+{
+	UI_COMMAND(OpenPluginWindow, "Minesweeper", "Bring up Minesweeper window", EUserInterfaceActionType::Button, FInputGesture());
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,107 @@
+﻿#include "MinesweeperNoGuessGenerator.h"
+
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperSolver.h"
+#include "MinesweeperStats.h"
+
+// Candidates per worker thread in each batch
+#define CANDIDATES_PER_WORKER 4
+
+TOptional<uint64> FMinesweeperNoGuessGenerator::FindSeed(int32 Width, int32 Height, int32 MinesCount, uint64 Seed, int32 MaxAttempts, const TAtomic<bool>* bCancel)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperFindNoGuessingSeed);
+
+	// We work through the candidates in batches, so we stop soon after the first solvable one rather than trying them all
+	// Each batch has a few candidates per worker, so workers stay busy while some candidates take longer than others
+	const int32 BatchSize = (FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) * CANDIDATES_PER_WORKER;
+
+	for (int32 BatchStart = 0; BatchStart < MaxAttempts; BatchStart += BatchSize)
+	{
+		if (bCancel != nullptr && bCancel->Load())
+		{
+			return TOptional<uint64>();
+		}
+
+		TAtomic<int32> FoundAttempt(MAX_int32);
+
+		ParallelFor(FMath::Min(BatchSize, MaxAttempts - BatchStart), [&](int32 Index)
+		{
+			const int32 Attempt = BatchStart + Index;
+
+			// A candidate after one that's already solvable could never be picked, so it isn't worth checking
+			if (Attempt > FoundAttempt.Load() || (bCancel != nullptr && bCancel->Load()))
+			{
+				return;
+			}
+
+			if (IsSolvableWithoutGuessing(Width, Height, MinesCount, GetCandidateSeed(Seed, Attempt)))
+			{
+				// Keep the earliest solvable candidate, whichever order they finished in
+				int32 CurrentAttempt = FoundAttempt.Load();
+				while (Attempt < CurrentAttempt && !FoundAttempt.CompareExchange(CurrentAttempt, Attempt))
+				{
+				}
+			}
+		});
+
+		// Every candidate before the one we found was checked, so this is the first solvable candidate overall
+		if (FoundAttempt.Load() != MAX_int32)
+		{
+			return GetCandidateSeed(Seed, FoundAttempt.Load());
+		}
+	}
+
+	return TOptional<uint64>();
+}
+
+bool FMinesweeperNoGuessGenerator::IsSolvableWithoutGuessing(int32 Width, int32 Height, int32 MinesCount, uint64 Seed)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperNoGuessGenerator::IsSolvableWithoutGuessing);
+
+	FMinesweeperBoard Board;
+	FMinesweeperSolver Solver(Board);
+
+	const int32 StartingPoint = Board.GenerateMinesData(Width, Height, MinesCount, Seed);
+	if (StartingPoint < 0)
+	{
+		return false;
+	}
+
+	// Play the board from the hint, revealing everything the solver can prove is safe until it runs out of safe cells.
+	// The board is solved once every cell that isn't a mine has been revealed, which the board knows as soon as it happens.
+	Board.ActivateCell(StartingPoint);
+	TArray<FMinesweeperMove> Moves;
+
+	while (Board.CanPlay())
+	{
+		Solver.Solve();
+
+		const TArray<int32>& SafeCells = Solver.GetSafeCells();
+		if (SafeCells.Num() == 0)
+		{
+			break;
+		}
+
+		// Every safe cell is revealed in one batch, so the solver hears about them all at once rather than one at a time.
+		// Cells a cascade reaches before their own move are skipped by the board
+		Moves.Reset();
+		for (const int32 SafeCell : SafeCells)
+		{
+			Moves.Emplace(EMinesweeperMoveType::Reveal, SafeCell);
+		}
+
+		Board.ApplyMoves(Moves);
+	}
+
+	return Board.HasWon();
+}
+
+uint64 FMinesweeperNoGuessGenerator::GetCandidateSeed(uint64 Seed, int32 Attempt)
+{
+	return Attempt == 0 ? Seed : FMinesweeperRandomStream::Mix(Seed + uint64(Attempt) * 0x9E3779B97F4A7C15ull);
+}
+
+#undef CANDIDATES_PER_WORKER
@@ -0,0 +1,739 @@
+﻿#include "MinesweeperProbability.h"
+
+#include "Misc/Crc.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperSolver.h"
+#include "MinesweeperStats.h"
+
+namespace MinesweeperProbability
+{
+	/* Distribution of the total mines of two independent sets of cells, from the distribution of each.
+	 * B[K] is the weight of OffsetB + K mines, while A and the result start from none
+	 */
+	static void Convolve(const TArray<double>& A, const TArray<double>& B, int32 OffsetB, TArray<double>& OutResult)
+	{
+		OutResult.Reset();
+		OutResult.SetNumZeroed(A.Num() + OffsetB + B.Num() - 1);
+
+		for (int32 IndexA = 0; IndexA < A.Num(); IndexA++)
+		{
+			if (A[IndexA] != 0.0)
+			{
+				for (int32 IndexB = 0; IndexB < B.Num(); IndexB++)
+				{
+					OutResult[IndexA + OffsetB + IndexB] += A[IndexA] * B[IndexB];
+				}
+			}
+		}
+	}
+}
+
+FMinesweeperProbability::FMinesweeperProbability()
+	: bExact(true)
+{
+}
+
+void FMinesweeperProbability::Compute(const FMinesweeperBoard& Board, const FMinesweeperSolver& Solver)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperComputeProbabilities);
+
+	const int32 NumCells = Board.Num();
+
+	Probabilities.Reset();
+	Probabilities.SetNumZeroed(NumCells);
+	bExact = true;
+
+	if (!Board.CanPlay())
+	{
+		Components.Reset();
+		return;
+	}
+
+	// Gather the constraints, and the frontier cells they're made of. Cells which share a constraint are joined
+	// with a union-find, so each set left at the end is a component
+	struct FConstraint
+	{
+		int32 Idx;
+		int32 Mines;
+		TArray<int32, TInlineAllocator<8>> Cells;
+	};
+
+	TArray<FConstraint> Constraints;
+	TArray<int32> FrontierCells;
+	TArray<int32> Parents;
+
+	// Frontier index of every cell that's on the frontier, and later its index within its component
+	TArray<int32> FrontierIndex;
+	FrontierIndex.Init(INDEX_NONE, NumCells);
+
+	auto FindRoot = [&Parents](int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	};
+
+	int32 KnownMines = 0;
+	int32 NumUnknown = 0;
+
+	for (int32 Idx = 0; Idx < NumCells; Idx++)
+	{
+		const EMinesweeperCellKnowledge Knowledge = Solver.GetKnowledge(Idx);
+		if (Knowledge == EMinesweeperCellKnowledge::Mine)
+		{
+			KnownMines++;
+			Probabilities[Idx] = 1.0f;
+			continue;
+		}
+
+		if (Knowledge == EMinesweeperCellKnowledge::Unknown)
+		{
+			NumUnknown++;
+			continue;
+		}
+
+		// Safe cells that haven't been revealed yet stay at 0, and only revealed numbers are constraints
+		const FCellData& Cell = Board.GetCell(Idx);
+		if (!Cell.WasActivated() || Cell.GetNearbyMinesCount() == 0)
+		{
+			continue;
+		}
+
+		FConstraint Constraint;
+		Constraint.Idx = Idx;
+		Constraint.Mines = Cell.GetNearbyMinesCount();
+
+		const int32 Row = Board.GetRow(Idx);
+		const int32 Col = Board.GetCol(Idx);
+
+		for (int32 AdjacentRow = FMath::Max(Row - 1, 0); AdjacentRow <= FMath::Min(Row + 1, Board.GetHeight() - 1); AdjacentRow++)
+		{
+			for (int32 AdjacentCol = FMath::Max(Col - 1, 0); AdjacentCol <= FMath::Min(Col + 1, Board.GetWidth() - 1); AdjacentCol++)
+			{
+				const int32 AdjacentIdx = Board.GetIndex(AdjacentRow, AdjacentCol);
+				const EMinesweeperCellKnowledge AdjacentKnowledge = Solver.GetKnowledge(AdjacentIdx);
+
+				if (AdjacentKnowledge == EMinesweeperCellKnowledge::Mine)
+				{
+					Constraint.Mines--;
+				}
+				else if (AdjacentKnowledge == EMinesweeperCellKnowledge::Unknown)
+				{
+					Constraint.Cells.Add(AdjacentIdx);
+				}
+			}
+		}
+
+		if (Constraint.Cells.Num() == 0)
+		{
+			continue;
+		}
+
+		for (const int32 ConstraintCell : Constraint.Cells)
+		{
+			if (FrontierIndex[ConstraintCell] == INDEX_NONE)
+			{
+				FrontierIndex[ConstraintCell] = FrontierCells.Add(ConstraintCell);
+				Parents.Add(FrontierIndex[ConstraintCell]);
+			}
+		}
+
+		const int32 Root = FindRoot(FrontierIndex[Constraint.Cells[0]]);
+		for (const int32 ConstraintCell : Constraint.Cells)
+		{
+			Parents[FindRoot(FrontierIndex[ConstraintCell])] = Root;
+		}
+
+		Constraints.Add(MoveTemp(Constraint));
+	}
+
+	// Split the frontier and the constraints into components
+	TArray<FComponent> NewComponents;
+	TArray<int32> RootComponents;
+	RootComponents.Init(INDEX_NONE, FrontierCells.Num());
+
+	for (int32 Index = 0; Index < FrontierCells.Num(); Index++)
+	{
+		int32& ComponentIndex = RootComponents[FindRoot(Index)];
+		if (ComponentIndex == INDEX_NONE)
+		{
+			ComponentIndex = NewComponents.AddDefaulted();
+		}
+
+		NewComponents[ComponentIndex].Cells.Add(FrontierCells[Index]);
+	}
+
+	TArray<int32> ConstraintComponents;
+	ConstraintComponents.Reserve(Constraints.Num());
+	for (const FConstraint& Constraint : Constraints)
+	{
+		ConstraintComponents.Add(RootComponents[FindRoot(FrontierIndex[Constraint.Cells[0]])]);
+	}
+
+	for (FComponent& Component : NewComponents)
+	{
+		Component.Cells.Sort();
+		for (int32 Index = 0; Index < Component.Cells.Num(); Index++)
+		{
+			FrontierIndex[Component.Cells[Index]] = Index;
+		}
+
+		Component.Key = Component.Cells;
+		Component.Key.Add(INDEX_NONE);
+	}
+
+	for (int32 ConstraintIndex = 0; ConstraintIndex < Constraints.Num(); ConstraintIndex++)
+	{
+		const FConstraint& Constraint = Constraints[ConstraintIndex];
+		FComponent& Component = NewComponents[ConstraintComponents[ConstraintIndex]];
+
+		TArray<int32>& LocalCells = Component.ConstraintCells.AddDefaulted_GetRef();
+		for (const int32 ConstraintCell : Constraint.Cells)
+		{
+			LocalCells.Add(FrontierIndex[ConstraintCell]);
+		}
+
+		Component.ConstraintMines.Add(Constraint.Mines);
+		Component.Key.Add(Constraint.Idx);
+		Component.Key.Add(Constraint.Mines);
+	}
+
+	// Components the last move didn't touch have exactly the same cells and constraints as before, so their solutions are reused
+	TMap<uint32, int32> PreviousComponents;
+	for (int32 Index = 0; Index < Components.Num(); Index++)
+	{
+		PreviousComponents.Add(Components[Index].KeyHash, Index);
+	}
+
+	for (FComponent& Component : NewComponents)
+	{
+		Component.KeyHash = FCrc::MemCrc32(Component.Key.GetData(), Component.Key.Num() * sizeof(int32));
+
+		const int32* PreviousIndex = PreviousComponents.Find(Component.KeyHash);
+		if (PreviousIndex != nullptr && Components[*PreviousIndex].Key == Component.Key)
+		{
+			Component = MoveTemp(Components[*PreviousIndex]);
+		}
+		else
+		{
+			SolveComponent(Component, Board.GetSeed() ^ Component.KeyHash);
+		}
+
+		bExact &= Component.bExact;
+	}
+
+	Components = MoveTemp(NewComponents);
+
+	// Combine the components. Totals[M] is the weight of the frontier holding M mines, and the remaining mines are
+	// spread over the interior cells, which can be done in Binomial(Interior, Remaining - M) ways.
+	// Prefixes are kept so that every component can get the distribution of all the other components
+	const int32 NumComponents = Components.Num();
+	const int32 RemainingMines = Board.GetMinesCount() - KnownMines;
+	const int32 NumInterior = NumUnknown - FrontierCells.Num();
+
+	TArray<TArray<double>> Prefixes;
+	Prefixes.SetNum(NumComponents + 1);
+	Prefixes[0].Add(1.0);
+
+	for (int32 Index = 0; Index < NumComponents; Index++)
+	{
+		MinesweeperProbability::Convolve(Prefixes[Index], Components[Index].Weights, Components[Index].MinMines, Prefixes[Index + 1]);
+	}
+
+	const TArray<double>& Totals = Prefixes[NumComponents];
+
+	// The binomials are far too large for doubles, so they're worked out as logs relative to each other, using
+	// Binomial(N, K - 1) / Binomial(N, K) = K / (N - K + 1), and scaled so the largest term of the sum is 1
+	TArray<double> LogBinomials;
+	LogBinomials.SetNumZeroed(Totals.Num());
+
+	const int32 MinFrontierMines = FMath::Max(RemainingMines - NumInterior, 0);
+	const int32 MaxFrontierMines = FMath::Min(RemainingMines, Totals.Num() - 1);
+
+	double MaxLogWeight = TNumericLimits<double>::Lowest();
+	for (int32 FrontierMines = MinFrontierMines; FrontierMines <= MaxFrontierMines; FrontierMines++)
+	{
+		if (FrontierMines > MinFrontierMines)
+		{
+			const int32 InteriorMines = RemainingMines - FrontierMines + 1;
+			LogBinomials[FrontierMines] = LogBinomials[FrontierMines - 1] + log(double(InteriorMines) / double(NumInterior - InteriorMines + 1));
+		}
+
+		if (Totals[FrontierMines] > 0.0)
+		{
+			MaxLogWeight = FMath::Max(MaxLogWeight, LogBinomials[FrontierMines] + log(Totals[FrontierMines]));
+		}
+	}
+
+	// No arrangement of the remaining mines fits what the player can see
+	if (MaxLogWeight == TNumericLimits<double>::Lowest())
+	{
+		return;
+	}
+
+	TArray<double> Binomials;
+	Binomials.SetNumZeroed(Totals.Num());
+
+	double TotalWeight = 0.0;
+	double InteriorWeight = 0.0;
+
+	for (int32 FrontierMines = MinFrontierMines; FrontierMines <= MaxFrontierMines; FrontierMines++)
+	{
+		if (Totals[FrontierMines] > 0.0)
+		{
+			Binomials[FrontierMines] = exp(LogBinomials[FrontierMines] - MaxLogWeight);
+
+			const double Weight = Totals[FrontierMines] * Binomials[FrontierMines];
+			TotalWeight += Weight;
+
+			if (NumInterior > 0)
+			{
+				InteriorWeight += Weight * double(RemainingMines - FrontierMines) / double(NumInterior);
+			}
+		}
+	}
+
+	const float InteriorProbability = float(InteriorWeight / TotalWeight);
+
+	// Walk back through the components with the suffix of the ones after, which with the prefix gives all the others
+	TArray<double> Suffix;
+	Suffix.Add(1.0);
+	TArray<double> Others;
+	TArray<double> NextSuffix;
+	TArray<double> OtherWeights;
+
+	for (int32 ComponentIndex = NumComponents - 1; ComponentIndex >= 0; ComponentIndex--)
+	{
+		const FComponent& Component = Components[ComponentIndex];
+		const int32 NumComponentCells = Component.Cells.Num();
+
+		MinesweeperProbability::Convolve(Prefixes[ComponentIndex], Suffix, 0, Others);
+
+		// OtherWeights[K] is the weight of everything outside this component, given it holds MinMines + K mines
+		OtherWeights.Reset();
+		OtherWeights.SetNumZeroed(Component.Weights.Num());
+
+		for (int32 WeightIndex = 0; WeightIndex < Component.Weights.Num(); WeightIndex++)
+		{
+			const int32 ComponentMines = Component.MinMines + WeightIndex;
+			for (int32 OtherMines = 0; OtherMines < Others.Num() && ComponentMines + OtherMines < Binomials.Num(); OtherMines++)
+			{
+				OtherWeights[WeightIndex] += Others[OtherMines] * Binomials[ComponentMines + OtherMines];
+			}
+		}
+
+		for (int32 Index = 0; Index < NumComponentCells; Index++)
+		{
+			double CellWeight = 0.0;
+			for (int32 WeightIndex = 0; WeightIndex < Component.Weights.Num(); WeightIndex++)
+			{
+				CellWeight += Component.CellWeights[WeightIndex * NumComponentCells + Index] * OtherWeights[WeightIndex];
+			}
+
+			Probabilities[Component.Cells[Index]] = float(CellWeight / TotalWeight);
+		}
+
+		MinesweeperProbability::Convolve(Suffix, Component.Weights, Component.MinMines, NextSuffix);
+		Swap(Suffix, NextSuffix);
+	}
+
+	// Every unknown cell away from the frontier is alike, so they all share the same probability
+	for (int32 Idx = 0; Idx < NumCells; Idx++)
+	{
+		if (Solver.GetKnowledge(Idx) == EMinesweeperCellKnowledge::Unknown && FrontierIndex[Idx] == INDEX_NONE)
+		{
+			Probabilities[Idx] = InteriorProbability;
+		}
+	}
+}
+
+void FMinesweeperProbability::SolveComponent(FComponent& Component, uint64 Seed) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperProbability::SolveComponent);
+
+	const int32 NumComponentCells = Component.Cells.Num();
+	const int32 NumConstraints = Component.ConstraintCells.Num();
+
+	CellConstraints.SetNum(NumComponentCells);
+	for (TArray<int32>& Constraints : CellConstraints)
+	{
+		Constraints.Reset();
+	}
+
+	for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints; ConstraintIndex++)
+	{
+		for (const int32 Cell : Component.ConstraintCells[ConstraintIndex])
+		{
+			CellConstraints[Cell].Add(ConstraintIndex);
+		}
+	}
+
+	// Enumerate the cells breadth first along their constraints, so constraints are completed, and bad assignments
+	// are pruned, as early as possible. The cells are stored in that order
+	TArray<int32> Order;
+	Order.Reserve(NumComponentCells);
+	TArray<int32> NewIndices;
+	NewIndices.Init(INDEX_NONE, NumComponentCells);
+
+	Order.Add(0);
+	NewIndices[0] = 0;
+
+	for (int32 OrderIndex = 0; OrderIndex < Order.Num(); OrderIndex++)
+	{
+		for (const int32 ConstraintIndex : CellConstraints[Order[OrderIndex]])
+		{
+			for (const int32 Cell : Component.ConstraintCells[ConstraintIndex])
+			{
+				if (NewIndices[Cell] == INDEX_NONE)
+				{
+					NewIndices[Cell] = Order.Add(Cell);
+				}
+			}
+		}
+	}
+
+	check(Order.Num() == NumComponentCells)
+
+	TArray<TArray<int32>> OrderedCellConstraints;
+	OrderedCellConstraints.SetNum(NumComponentCells);
+
+	TArray<int32> OrderedCells;
+	OrderedCells.Reserve(NumComponentCells);
+
+	for (int32 Index = 0; Index < NumComponentCells; Index++)
+	{
+		OrderedCells.Add(Component.Cells[Order[Index]]);
+		OrderedCellConstraints[Index] = MoveTemp(CellConstraints[Order[Index]]);
+	}
+
+	Component.Cells = MoveTemp(OrderedCells);
+	Swap(CellConstraints, OrderedCellConstraints);
+
+	for (TArray<int32>& Cells : Component.ConstraintCells)
+	{
+		for (int32& Cell : Cells)
+		{
+			Cell = NewIndices[Cell];
+		}
+	}
+
+	TArray<int32> ConstraintMinesLeft(Component.ConstraintMines);
+	TArray<int32> ConstraintCellsLeft;
+	ConstraintCellsLeft.Reserve(NumConstraints);
+	for (const TArray<int32>& Cells : Component.ConstraintCells)
+	{
+		ConstraintCellsLeft.Add(Cells.Num());
+	}
+
+	TArray<uint8> Assignment;
+	Assignment.SetNumZeroed(NumComponentCells);
+
+	// The weights start out empty, and Record widens them to each mine count a solution is found for
+	auto ResetWeights = [&Component]()
+	{
+		Component.Weights.Reset();
+		Component.CellWeights.Reset();
+		Component.MinMines = 0;
+	};
+
+	ResetWeights();
+
+	int32 StepsLeft = MaxEnumerationSteps;
+	Component.bExact = Enumerate(Component, ConstraintMinesLeft, ConstraintCellsLeft, Assignment, StepsLeft);
+
+	if (!Component.bExact)
+	{
+		// Enumeration stopped part way, and unassigned everything before it gave up, so we can start again from a clean slate
+		ResetWeights();
+
+		FMinesweeperRandomStream Stream(Seed);
+		for (int32 SampleIndex = 0; SampleIndex < NumSamples; SampleIndex++)
+		{
+			int32 SampleStepsLeft = SampleStepsPerCell * NumComponentCells;
+			Sample(Component, ConstraintMinesLeft, ConstraintCellsLeft, Assignment, SampleStepsLeft, Stream);
+		}
+	}
+
+	// A component nothing fits has no weight for any mine count
+	if (Component.Weights.Num() == 0)
+	{
+		Component.Weights.Add(0.0);
+		Component.CellWeights.SetNumZeroed(NumComponentCells);
+	}
+
+	// Solution counts grow exponentially with the size of the component, so they're scaled down before combining
+	double MaxWeight = 0.0;
+	for (const double Weight : Component.Weights)
+	{
+		MaxWeight = FMath::Max(MaxWeight, Weight);
+	}
+
+	if (MaxWeight > 0.0)
+	{
+		for (double& Weight : Component.Weights)
+		{
+			Weight /= MaxWeight;
+		}
+
+		for (double& Weight : Component.CellWeights)
+		{
+			Weight /= MaxWeight;
+		}
+	}
+
+	// Mine counts no solution uses, left at either end when the weights were widened, only make combining slower
+	int32 NumWeights = Component.Weights.Num();
+	while (NumWeights > 1 && Component.Weights[NumWeights - 1] == 0.0)
+	{
+		NumWeights--;
+	}
+
+	Component.Weights.SetNum(NumWeights);
+	Component.CellWeights.SetNum(NumWeights * NumComponentCells);
+
+	int32 NumLeading = 0;
+	while (NumLeading < NumWeights - 1 && Component.Weights[NumLeading] == 0.0)
+	{
+		NumLeading++;
+	}
+
+	if (NumLeading > 0)
+	{
+		Component.Weights.RemoveAt(0, NumLeading);
+		Component.CellWeights.RemoveAt(0, NumLeading * NumComponentCells);
+		Component.MinMines += NumLeading;
+	}
+}
+
+bool FMinesweeperProbability::Enumerate(FComponent& Component, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft, TArray<uint8>& Assignment, int32& StepsLeft) const
+{
+	const int32 NumComponentCells = Component.Cells.Num();
+	Attempts.Reset();
+	Attempts.SetNumZeroed(NumComponentCells);
+
+	int32 CellIndex = 0;
+	int32 NumMines = 0;
+
+	while (true)
+	{
+		// Every cell belongs to a constraint and every assignment was checked against them, so all of them are met
+		if (CellIndex == NumComponentCells)
+		{
+			Record(Component, Assignment, NumMines);
+		}
+		else if (Attempts[CellIndex] < 2)
+		{
+			if (Attempts[CellIndex] == 0 && --StepsLeft < 0)
+			{
+				UnassignAll(Component, CellIndex, Assignment, ConstraintMinesLeft, ConstraintCellsLeft);
+				return false;
+			}
+
+			// No mine is tried first, then a mine, and the cell after starts over each time we move on to it
+			const uint8 bMine = Attempts[CellIndex]++;
+			if (Assign(CellIndex, bMine, ConstraintMinesLeft, ConstraintCellsLeft))
+			{
+				Assignment[CellIndex] = bMine;
+				NumMines += bMine;
+
+				if (++CellIndex < NumComponentCells)
+				{
+					Attempts[CellIndex] = 0;
+				}
+			}
+
+			continue;
+		}
+
+		// Both values of this cell are done with, so back up to the cell before and take its value back
+		if (CellIndex == 0)
+		{
+			return true;
+		}
+
+		CellIndex--;
+		Unassign(Component, CellIndex, Assignment[CellIndex], ConstraintMinesLeft, ConstraintCellsLeft);
+		NumMines -= Assignment[CellIndex];
+	}
+}
+
+bool FMinesweeperProbability::Sample(FComponent& Component, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft, TArray<uint8>& Assignment, int32& StepsLeft, FMinesweeperRandomStream& Stream) const
+{
+	const int32 NumComponentCells = Component.Cells.Num();
+	Attempts.Reset();
+	Attempts.SetNumZeroed(NumComponentCells);
+	FirstAttempts.Reset();
+	FirstAttempts.SetNumZeroed(NumComponentCells);
+
+	int32 CellIndex = 0;
+	int32 NumMines = 0;
+
+	while (true)
+	{
+		if (CellIndex == NumComponentCells)
+		{
+			Record(Component, Assignment, NumMines);
+			UnassignAll(Component, CellIndex, Assignment, ConstraintMinesLeft, ConstraintCellsLeft);
+			return true;
+		}
+
+		if (Attempts[CellIndex] < 2)
+		{
+			if (Attempts[CellIndex] == 0)
+			{
+				if (--StepsLeft < 0)
+				{
+					UnassignAll(Component, CellIndex, Assignment, ConstraintMinesLeft, ConstraintCellsLeft);
+					return false;
+				}
+
+				// Try a mine first about as often as the cell's first constraint still needs one, so most samples succeed straight away
+				const int32 ConstraintIndex = CellConstraints[CellIndex][0];
+				FirstAttempts[CellIndex] = Stream.RandRange(1, ConstraintCellsLeft[ConstraintIndex]) <= ConstraintMinesLeft[ConstraintIndex] ? 1 : 0;
+			}
+
+			const uint8 bMine = FirstAttempts[CellIndex] ^ Attempts[CellIndex]++;
+			if (Assign(CellIndex, bMine, ConstraintMinesLeft, ConstraintCellsLeft))
+			{
+				Assignment[CellIndex] = bMine;
+				NumMines += bMine;
+
+				if (++CellIndex < NumComponentCells)
+				{
+					Attempts[CellIndex] = 0;
+				}
+			}
+
+			continue;
+		}
+
+		if (CellIndex == 0)
+		{
+			return false;
+		}
+
+		CellIndex--;
+		Unassign(Component, CellIndex, Assignment[CellIndex], ConstraintMinesLeft, ConstraintCellsLeft);
+		NumMines -= Assignment[CellIndex];
+	}
+}
+
+void FMinesweeperProbability::UnassignAll(const FComponent& Component, int32 CellIndex, const TArray<uint8>& Assignment, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft) const
+{
+	for (int32 Index = 0; Index < CellIndex; Index++)
+	{
+		Unassign(Component, Index, Assignment[Index], ConstraintMinesLeft, ConstraintCellsLeft);
+	}
+}
+
+bool FMinesweeperProbability::Assign(int32 CellIndex, uint8 bMine, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft) const
+{
+	// Each constraint must still need no more mines than it has cells left, and never fewer than none
+	for (const int32 ConstraintIndex : CellConstraints[CellIndex])
+	{
+		const int32 MinesLeft = ConstraintMinesLeft[ConstraintIndex] - bMine;
+		if (MinesLeft < 0 || MinesLeft > ConstraintCellsLeft[ConstraintIndex] - 1)
+		{
+			return false;
+		}
+	}
+
+	for (const int32 ConstraintIndex : CellConstraints[CellIndex])
+	{
+		ConstraintMinesLeft[ConstraintIndex] -= bMine;
+		ConstraintCellsLeft[ConstraintIndex]--;
+	}
+
+	return true;
+}
+
+void FMinesweeperProbability::Unassign(const FComponent& Component, int32 CellIndex, uint8 bMine, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft) const
+{
+	for (const int32 ConstraintIndex : CellConstraints[CellIndex])
+	{
+		ConstraintMinesLeft[ConstraintIndex] += bMine;
+		ConstraintCellsLeft[ConstraintIndex]++;
+	}
+}
+
+void FMinesweeperProbability::Record(FComponent& Component, const TArray<uint8>& Assignment, int32 NumMines) const
+{
+	if (NumMines < Component.MinMines || NumMines >= Component.MinMines + Component.Weights.Num())
+	{
+		GrowWeights(Component, NumMines);
+	}
+
+	const int32 NumComponentCells = Component.Cells.Num();
+	const int32 WeightIndex = NumMines - Component.MinMines;
+	double* CellWeights = Component.CellWeights.GetData() + WeightIndex * NumComponentCells;
+
+	Component.Weights[WeightIndex] += 1.0;
+	for (int32 Index = 0; Index < NumComponentCells; Index++)
+	{
+		CellWeights[Index] += Assignment[Index];
+	}
+}
+
+void FMinesweeperProbability::GrowWeights(FComponent& Component, int32 NumMines) const
+{
+	const int32 NumComponentCells = Component.Cells.Num();
+	const int32 OldNumWeights = Component.Weights.Num();
+
+	// Widen by at least as many mine counts as are already covered, so the weights are only copied a few times even when
+	// the solutions spread over many mine counts
+	int32 NewMinMines = NumMines;
+	int32 NewMaxMines = NumMines;
+
+	if (OldNumWeights > 0)
+	{
+		const int32 OldMaxMines = Component.MinMines + OldNumWeights - 1;
+		NewMinMines = NumMines < Component.MinMines ? FMath::Max(FMath::Min(NumMines, Component.MinMines - OldNumWeights), 0) : Component.MinMines;
+		NewMaxMines = NumMines > OldMaxMines ? FMath::Min(FMath::Max(NumMines, OldMaxMines + OldNumWeights), NumComponentCells) : OldMaxMines;
+	}
+
+	const int32 NewNumWeights = NewMaxMines - NewMinMines + 1;
+	const int32 Shift = Component.MinMines - NewMinMines;
+
+	TArray<double> Weights;
+	Weights.SetNumZeroed(NewNumWeights);
+	TArray<double> CellWeights;
+	CellWeights.SetNumZeroed(NewNumWeights * NumComponentCells);
+
+	if (OldNumWeights > 0)
+	{
+		FMemory::Memcpy(Weights.GetData() + Shift, Component.Weights.GetData(), OldNumWeights * sizeof(double));
+		FMemory::Memcpy(CellWeights.GetData() + Shift * NumComponentCells, Component.CellWeights.GetData(), OldNumWeights * NumComponentCells * sizeof(double));
+	}
+
+	Component.Weights = MoveTemp(Weights);
+	Component.CellWeights = MoveTemp(CellWeights);
+	Component.MinMines = NewMinMines;
+}
+
+float FMinesweeperProbability::GetMineProbability(int32 Idx) const
+{
+	check(Idx < Probabilities.Num())
+
+	return Probabilities[Idx];
+}
+
+TArrayView<const float> FMinesweeperProbability::GetMineProbabilities() const
+{
+	return Probabilities;
+}
+
+bool FMinesweeperProbability::IsExact() const
+{
+	return bExact;
+}
+
+void FMinesweeperProbability::Reset()
+{
+	Components.Reset();
+	Probabilities.Reset();
+	bExact = true;
+}
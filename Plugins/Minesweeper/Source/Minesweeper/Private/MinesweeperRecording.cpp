@@ -0,0 +1,432 @@
+﻿#include "MinesweeperRecording.h"
+
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperStats.h"
+
+// "MSWR" read as a little endian uint32, the first 4 bytes of every log
+#define RECORDING_MAGIC 0x5257534Du
+
+namespace MinesweeperRecording
+{
+	// Every record starts with a tag: the type of an input, or this for the start of a game
+	static constexpr uint8 GameTag = 0x80;
+
+	static bool IsMove(EMinesweeperInputType Type)
+	{
+		return Type == EMinesweeperInputType::Reveal || Type == EMinesweeperInputType::Flag || Type == EMinesweeperInputType::Chord;
+	}
+
+	/* Append a value 7 bits at a time, lowest first, with the top bit of each byte set if more follow */
+	static void WriteVarInt(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add(static_cast<uint8>(Value | 0x80));
+			Value >>= 7;
+		}
+
+		Out.Add(static_cast<uint8>(Value));
+	}
+
+	static void WriteUInt64(TArray<uint8>& Out, uint64 Value)
+	{
+		for (int32 Byte = 0; Byte < 8; Byte++)
+		{
+			Out.Add(static_cast<uint8>(Value >> (Byte * 8)));
+		}
+	}
+
+	// Reads records out of a log, remembering whether a read failed because the log ran out or because it's corrupt
+	struct FReader
+	{
+		FReader(TArrayView<const uint8> InData)
+			: Data(InData)
+			, Offset(0)
+			, bTruncated(false)
+		{}
+
+		bool IsAtEnd() const
+		{
+			return Offset >= Data.Num();
+		}
+
+		bool ReadByte(uint8& OutByte)
+		{
+			if (IsAtEnd())
+			{
+				bTruncated = true;
+				return false;
+			}
+
+			OutByte = Data[Offset++];
+			return true;
+		}
+
+		bool ReadVarInt(uint32& OutValue)
+		{
+			OutValue = 0;
+
+			// A uint32 never takes more than 5 bytes, so anything longer is corrupt
+			for (int32 Shift = 0; Shift < 35; Shift += 7)
+			{
+				uint8 Byte = 0;
+				if (!ReadByte(Byte))
+				{
+					return false;
+				}
+
+				OutValue |= static_cast<uint32>(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool ReadUInt64(uint64& OutValue)
+		{
+			OutValue = 0;
+			for (int32 Byte = 0; Byte < 8; Byte++)
+			{
+				uint8 Value = 0;
+				if (!ReadByte(Value))
+				{
+					return false;
+				}
+
+				OutValue |= static_cast<uint64>(Value) << (Byte * 8);
+			}
+
+			return true;
+		}
+
+		TArrayView<const uint8> Data;
+		int32 Offset;
+		bool bTruncated;
+	};
+}
+
+double FMinesweeperRecordedGame::GetDuration() const
+{
+	return Inputs.Num() > 0 ? Inputs.Last().Seconds : 0.0;
+}
+
+FMinesweeperRecorder::FMinesweeperRecorder()
+	: bRecordingGame(false)
+	, GameStartSeconds(0.0)
+	, LastInputMilliseconds(0)
+{
+}
+
+FMinesweeperRecorder::~FMinesweeperRecorder()
+{
+	Close();
+}
+
+FString FMinesweeperRecorder::GetDefaultFilename()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Minesweeper"), TEXT("Inputs.mswlog"));
+}
+
+bool FMinesweeperRecorder::Open(const TCHAR* Filename)
+{
+	using namespace MinesweeperRecording;
+
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+
+	// Only a new log gets a header, every game after that is appended to whatever is already there.
+	// Reading is allowed, so a log can be replayed while it's still being recorded to
+	const bool bNewLog = PlatformFile.FileSize(Filename) <= 0;
+	FileHandle.Reset(PlatformFile.OpenWrite(Filename, true, true));
+
+	if (!FileHandle.IsValid())
+	{
+		return false;
+	}
+
+	if (bNewLog)
+	{
+		const uint32 Magic = RECORDING_MAGIC;
+		for (int32 Byte = 0; Byte < 4; Byte++)
+		{
+			Buffer.Add(static_cast<uint8>(Magic >> (Byte * 8)));
+		}
+
+		Buffer.Add(static_cast<uint8>(Version));
+		Buffer.Add(static_cast<uint8>(Version >> 8));
+		Flush();
+	}
+
+	return true;
+}
+
+void FMinesweeperRecorder::Close()
+{
+	FileHandle.Reset();
+	bRecordingGame = false;
+}
+
+bool FMinesweeperRecorder::IsOpen() const
+{
+	return FileHandle.IsValid();
+}
+
+void FMinesweeperRecorder::BeginGame(int32 Width, int32 Height, int32 MinesCount, uint64 Seed)
+{
+	using namespace MinesweeperRecording;
+
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	Buffer.Add(GameTag);
+	WriteVarInt(Buffer, static_cast<uint32>(Width));
+	WriteVarInt(Buffer, static_cast<uint32>(Height));
+	WriteVarInt(Buffer, static_cast<uint32>(MinesCount));
+	WriteUInt64(Buffer, Seed);
+	Flush();
+
+	bRecordingGame = true;
+	GameStartSeconds = FPlatformTime::Seconds();
+	LastInputMilliseconds = 0;
+}
+
+void FMinesweeperRecorder::EndGame()
+{
+	bRecordingGame = false;
+}
+
+bool FMinesweeperRecorder::IsRecordingGame() const
+{
+	return IsOpen() && bRecordingGame;
+}
+
+void FMinesweeperRecorder::RecordInput(EMinesweeperInputType Type, int32 Idx)
+{
+	using namespace MinesweeperRecording;
+
+	if (!IsRecordingGame())
+	{
+		return;
+	}
+
+	// Times are stored as the difference from the input before, which is small enough to fit in a byte or two
+	const uint32 Milliseconds = static_cast<uint32>(FMath::Max((FPlatformTime::Seconds() - GameStartSeconds) * 1000.0, 0.0));
+	const uint32 DeltaMilliseconds = Milliseconds - FMath::Min(LastInputMilliseconds, Milliseconds);
+	LastInputMilliseconds = FMath::Max(LastInputMilliseconds, Milliseconds);
+
+	Buffer.Add(static_cast<uint8>(Type));
+	WriteVarInt(Buffer, DeltaMilliseconds);
+
+	if (IsMove(Type))
+	{
+		check(Idx >= 0)
+		WriteVarInt(Buffer, static_cast<uint32>(Idx));
+	}
+
+	Flush();
+}
+
+void FMinesweeperRecorder::Flush()
+{
+	// Each write is handed straight to the OS, which keeps it even if the editor goes down. The file handle isn't flushed,
+	// as that would wait for the disk on every click
+	if (FileHandle.IsValid() && Buffer.Num() > 0)
+	{
+		FileHandle->Write(Buffer.GetData(), Buffer.Num());
+	}
+
+	Buffer.Reset();
+}
+
+FString FMinesweeperReplayResult::ToString(const FMinesweeperRecordedGame& Game) const
+{
+	return FString::Printf(TEXT("%dx%d, %d mines, seed %llu: %d inputs over %.1fs replayed in %.3f ms, %d cells revealed, %s"),
+		Game.Width, Game.Height, Game.MinesCount, Game.Seed,
+		NumInputs, Game.GetDuration(), Seconds * 1000.0, NumCellsRevealed,
+		bWon ? TEXT("won") : bLost ? TEXT("lost") : TEXT("unfinished"));
+}
+
+bool FMinesweeperReplay::Parse(TArrayView<const uint8> Data, TArray<FMinesweeperRecordedGame>& OutGames)
+{
+	using namespace MinesweeperRecording;
+
+	OutGames.Reset();
+
+	FReader Reader(Data);
+	uint64 Header = 0;
+	for (int32 Byte = 0; Byte < 6; Byte++)
+	{
+		uint8 Value = 0;
+		if (!Reader.ReadByte(Value))
+		{
+			return false;
+		}
+
+		Header |= static_cast<uint64>(Value) << (Byte * 8);
+	}
+
+	if (static_cast<uint32>(Header) != RECORDING_MAGIC || static_cast<uint16>(Header >> 32) != FMinesweeperRecorder::Version)
+	{
+		return false;
+	}
+
+	// Each game's inputs are timed from the input before them, so this is where we are in the current game
+	uint64 Milliseconds = 0;
+
+	while (!Reader.IsAtEnd())
+	{
+		// A record that runs off the end of the log was being written when the log stopped, so it's left out.
+		// Anything else that can't be read means the log is corrupt
+		uint8 Tag = 0;
+		Reader.ReadByte(Tag);
+
+		if (Tag == GameTag)
+		{
+			uint32 Width = 0;
+			uint32 Height = 0;
+			uint32 MinesCount = 0;
+			uint64 Seed = 0;
+
+			if (!Reader.ReadVarInt(Width) || !Reader.ReadVarInt(Height) || !Reader.ReadVarInt(MinesCount) || !Reader.ReadUInt64(Seed))
+			{
+				return Reader.bTruncated;
+			}
+
+			// The same limits FMinesweeperBoard::GenerateMinesData works within
+			const uint64 NumCells = uint64(Width) * Height;
+			if (Width < 1 || Height < 1 || NumCells > MAX_int32 || MinesCount >= NumCells)
+			{
+				return false;
+			}
+
+			FMinesweeperRecordedGame& Game = OutGames.AddDefaulted_GetRef();
+			Game.Width = static_cast<int32>(Width);
+			Game.Height = static_cast<int32>(Height);
+			Game.MinesCount = static_cast<int32>(MinesCount);
+			Game.Seed = Seed;
+			Milliseconds = 0;
+		}
+		else if (Tag <= static_cast<uint8>(EMinesweeperInputType::Redo) && OutGames.Num() > 0)
+		{
+			FMinesweeperRecordedGame& Game = OutGames.Last();
+			const EMinesweeperInputType Type = static_cast<EMinesweeperInputType>(Tag);
+
+			uint32 DeltaMilliseconds = 0;
+			uint32 Idx = 0;
+			if (!Reader.ReadVarInt(DeltaMilliseconds) || (IsMove(Type) && !Reader.ReadVarInt(Idx)))
+			{
+				return Reader.bTruncated;
+			}
+
+			if (IsMove(Type) && Idx >= uint32(Game.Width) * uint32(Game.Height))
+			{
+				return false;
+			}
+
+			Milliseconds += DeltaMilliseconds;
+
+			FMinesweeperRecordedInput& Input = Game.Inputs.AddDefaulted_GetRef();
+			Input.Seconds = Milliseconds / 1000.0;
+			Input.Type = Type;
+			Input.Idx = IsMove(Type) ? static_cast<int32>(Idx) : INDEX_NONE;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FMinesweeperReplay::LoadFromFile(const TCHAR* Filename, TArray<FMinesweeperRecordedGame>& OutGames)
+{
+	TArray<uint8> Data;
+	return FFileHelper::LoadFileToArray(Data, Filename, FILEREAD_Silent) && Parse(Data, OutGames);
+}
+
+void FMinesweeperReplay::DealBoard(const FMinesweeperRecordedGame& Game, FMinesweeperBoard& Board)
+{
+	// The hint is recorded as an input like any other, so the starting point isn't needed
+	Board.GenerateMinesData(Game.Width, Game.Height, Game.MinesCount, Game.Seed);
+}
+
+int32 FMinesweeperReplay::ApplyInputs(TArrayView<const FMinesweeperRecordedInput> Inputs, FMinesweeperBoard& Board)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperReplay::ApplyInputs);
+
+	TArray<FMinesweeperMove> Moves;
+	Moves.Reserve(Inputs.Num());
+	int32 NumRevealed = 0;
+
+	// Undo and redo act on the moves before them, so every move before one has to be applied first
+	auto ApplyMoves = [&Moves, &NumRevealed, &Board]()
+	{
+		if (Moves.Num() > 0)
+		{
+			NumRevealed += Board.ApplyMoves(Moves);
+			Moves.Reset();
+		}
+	};
+
+	for (const FMinesweeperRecordedInput& Input : Inputs)
+	{
+		switch (Input.Type)
+		{
+		case EMinesweeperInputType::Reveal:
+			Moves.Emplace(EMinesweeperMoveType::Reveal, Input.Idx);
+			break;
+
+		case EMinesweeperInputType::Flag:
+			Moves.Emplace(EMinesweeperMoveType::Flag, Input.Idx);
+			break;
+
+		case EMinesweeperInputType::Chord:
+			Moves.Emplace(EMinesweeperMoveType::Chord, Input.Idx);
+			break;
+
+		case EMinesweeperInputType::Undo:
+			ApplyMoves();
+			Board.Undo();
+			break;
+
+		case EMinesweeperInputType::Redo:
+			ApplyMoves();
+			Board.Redo();
+			break;
+		}
+	}
+
+	ApplyMoves();
+
+	return NumRevealed;
+}
+
+FMinesweeperReplayResult FMinesweeperReplay::Play(const FMinesweeperRecordedGame& Game, FMinesweeperBoard& Board)
+{
+	DealBoard(Game, Board);
+
+	FMinesweeperReplayResult Result;
+	Result.NumInputs = Game.Inputs.Num();
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	Result.NumCellsRevealed = ApplyInputs(Game.Inputs, Board);
+	Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+	Result.bWon = Board.HasWon();
+	Result.bLost = Board.HasLost();
+
+	return Result;
+}
+
+#undef RECORDING_MAGIC
@@ -0,0 +1,167 @@
+﻿#include "MinesweeperSimulation.h"
+
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperProbability.h"
+#include "MinesweeperSolver.h"
+
+FMinesweeperSimulationResult FMinesweeperSimulation::Run(const FMinesweeperSimulationConfig& Config)
+{
+	const int32 NumTasks = FMath::Min(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, FMath::Max(Config.NumGames, 1));
+
+	// Each task adds up its own games, so nothing is shared between them but the next game to play
+	TArray<FMinesweeperSimulationResult> TaskResults;
+	TaskResults.SetNum(NumTasks);
+	TAtomic<int32> NextGame(0);
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	ParallelFor(NumTasks, [&](int32 Task)
+	{
+		FMinesweeperBoard Board;
+		FMinesweeperSolver Solver(Board);
+		FMinesweeperProbability Probability;
+
+		for (int32 Game = NextGame.IncrementExchange(); Game < Config.NumGames; Game = NextGame.IncrementExchange())
+		{
+			PlayGame(Board, Solver, Probability, Config, GetGameSeed(Config.Seed, Game), TaskResults[Task]);
+		}
+	});
+
+	FMinesweeperSimulationResult Result;
+	Result.Config = Config;
+	Result.Seconds = FPlatformTime::Seconds() - StartSeconds;
+
+	for (const FMinesweeperSimulationResult& TaskResult : TaskResults)
+	{
+		Result.NumGames += TaskResult.NumGames;
+		Result.NumWins += TaskResult.NumWins;
+		Result.NumReveals += TaskResult.NumReveals;
+		Result.NumCellsRevealed += TaskResult.NumCellsRevealed;
+		Result.NumGuesses += TaskResult.NumGuesses;
+		Result.NumCascades += TaskResult.NumCascades;
+		Result.NumCascadeCells += TaskResult.NumCascadeCells;
+		Result.MaxCascadeSize = FMath::Max(Result.MaxCascadeSize, TaskResult.MaxCascadeSize);
+	}
+
+	return Result;
+}
+
+bool FMinesweeperSimulation::PlayGame(FMinesweeperBoard& Board, FMinesweeperSolver& Solver, FMinesweeperProbability& Probability, const FMinesweeperSimulationConfig& Config, uint64 Seed, FMinesweeperSimulationResult& OutResult)
+{
+	OutResult.NumGames++;
+
+	const int32 StartingPoint = Board.GenerateMinesData(Config.Width, Config.Height, Config.MinesCount, Seed);
+	if (StartingPoint < 0)
+	{
+		return false;
+	}
+
+	auto Reveal = [&](int32 Idx)
+	{
+		const int32 Opened = Board.ActivateCell(Idx);
+
+		OutResult.NumReveals++;
+		OutResult.NumCellsRevealed += Opened;
+
+		if (Opened > 1)
+		{
+			OutResult.NumCascades++;
+			OutResult.NumCascadeCells += Opened;
+			OutResult.MaxCascadeSize = FMath::Max(OutResult.MaxCascadeSize, Opened);
+		}
+	};
+
+	Reveal(StartingPoint);
+
+	// The board counts the cells it has opened, so it knows the moment the game is won
+	while (Board.CanPlay())
+	{
+		Solver.Solve();
+
+		const TArray<int32>& SafeCells = Solver.GetSafeCells();
+		if (SafeCells.Num() > 0)
+		{
+			// Revealing one safe cell can cascade over others, and those are already revealed by the time we get to them
+			for (int32 SafeCellIndex = 0; SafeCellIndex < SafeCells.Num(); SafeCellIndex++)
+			{
+				if (!Board.GetCell(SafeCells[SafeCellIndex]).WasActivated())
+				{
+					Reveal(SafeCells[SafeCellIndex]);
+				}
+			}
+
+			continue;
+		}
+
+		// Nothing is certain, so guess the unknown cell least likely to be a mine. Ties go to the first one
+		Probability.Compute(Board, Solver);
+
+		int32 BestCell = INDEX_NONE;
+		float BestProbability = 2.f;
+
+		for (int32 Idx = 0; Idx < Board.Num(); Idx++)
+		{
+			if (Solver.GetKnowledge(Idx) == EMinesweeperCellKnowledge::Unknown && Probability.GetMineProbability(Idx) < BestProbability)
+			{
+				BestCell = Idx;
+				BestProbability = Probability.GetMineProbability(Idx);
+			}
+		}
+
+		if (BestCell == INDEX_NONE)
+		{
+			break;
+		}
+
+		OutResult.NumGuesses++;
+		Reveal(BestCell);
+	}
+
+	const bool bWon = Board.HasWon();
+	OutResult.NumWins += bWon ? 1 : 0;
+
+	return bWon;
+}
+
+uint64 FMinesweeperSimulation::GetGameSeed(uint64 Seed, int32 Game)
+{
+	return FMinesweeperRandomStream::Mix(Seed + uint64(Game) * 0x9E3779B97F4A7C15ull);
+}
+
+float FMinesweeperSimulationResult::GetWinRate() const
+{
+	return NumGames > 0 ? float(NumWins) / float(NumGames) : 0.f;
+}
+
+double FMinesweeperSimulationResult::GetAverageReveals() const
+{
+	return NumGames > 0 ? double(NumReveals) / double(NumGames) : 0.0;
+}
+
+double FMinesweeperSimulationResult::GetAverageCascadeSize() const
+{
+	return NumCascades > 0 ? double(NumCascadeCells) / double(NumCascades) : 0.0;
+}
+
+double FMinesweeperSimulationResult::GetGamesPerSecond() const
+{
+	return Seconds > 0.0 ? double(NumGames) / Seconds : 0.0;
+}
+
+double FMinesweeperSimulationResult::GetCellsPerSecond() const
+{
+	return Seconds > 0.0 ? double(NumCellsRevealed) / Seconds : 0.0;
+}
+
+FString FMinesweeperSimulationResult::ToString() const
+{
+	return FString::Printf(TEXT("%dx%d, %d mines: %d games, %.1f%% won, %.1f reveals and %.2f guesses per game, %.1f cells per cascade (max %d), %.0f games/s, %.0f cells/s"),
+		Config.Width, Config.Height, Config.MinesCount,
+		NumGames, GetWinRate() * 100.f,
+		GetAverageReveals(), NumGames > 0 ? double(NumGuesses) / double(NumGames) : 0.0,
+		GetAverageCascadeSize(), MaxCascadeSize,
+		GetGamesPerSecond(), GetCellsPerSecond());
+}
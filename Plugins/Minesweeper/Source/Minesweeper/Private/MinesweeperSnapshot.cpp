@@ -0,0 +1,504 @@
+﻿#include "MinesweeperSnapshot.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperChunkedBoard.h"
+
+// "MSWP" read as a little endian uint32, the first 4 bytes of every snapshot
+#define SNAPSHOT_MAGIC 0x5057534Du
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Snapshots are read and written as little endian words");
+
+namespace MinesweeperSnapshot
+{
+	enum class EKind : uint8
+	{
+		Board = 0,
+		ChunkedBoard = 1,
+	};
+
+	// Order of the planes of a board, and of their entries in FHeader::PlaneEncodings
+	enum EPlane
+	{
+		MinePlane = 0,
+		FlagPlane = 1,
+		RevealedPlane = 2,
+		NumPlanes = 3,
+	};
+
+	enum class EPlaneEncoding : uint8
+	{
+		// Nothing is set, and nothing is stored
+		Empty = 0,
+
+		// One bit per cell, in 64-bit words
+		Bits = 1,
+	};
+
+	// Written as is, so changing it means bumping FMinesweeperSnapshot::Version
+	struct FHeader
+	{
+		uint32 Magic;
+		uint16 Version;
+		uint8 Kind;
+		uint8 bCanPlay;
+		int32 Width;
+		int32 Height;
+		int64 MinesCount;
+		uint64 Seed;
+
+		// Chunked boards only
+		uint64 MineThreshold;
+		int32 NumChunks;
+		uint8 bInfinite;
+
+		// Boards only, how each of the planes after the header is stored
+		uint8 PlaneEncodings[NumPlanes];
+	};
+
+	static_assert(sizeof(FHeader) == 48, "The snapshot header is expected to have no padding, so every plane after it starts on a word");
+
+	// Every chunk is stored as its position followed by its flag and revealed planes
+	static constexpr int32 WordsPerChunkPlane = FMinesweeperChunkedBoard::ChunkSize * FMinesweeperChunkedBoard::ChunkSize / 64;
+	static constexpr int32 ChunkRecordSize = sizeof(int32) * 2 + sizeof(uint64) * WordsPerChunkPlane * 2;
+
+	static FHeader MakeHeader(EKind Kind)
+	{
+		FHeader Header;
+		FMemory::Memzero(Header);
+		Header.Magic = SNAPSHOT_MAGIC;
+		Header.Version = FMinesweeperSnapshot::Version;
+		Header.Kind = static_cast<uint8>(Kind);
+		return Header;
+	}
+
+	static bool ReadHeader(TArrayView<const uint8> Data, FHeader& OutHeader)
+	{
+		if (Data.Num() < int32(sizeof(FHeader)))
+		{
+			return false;
+		}
+
+		FMemory::Memcpy(&OutHeader, Data.GetData(), sizeof(FHeader));
+		return OutHeader.Magic == SNAPSHOT_MAGIC && OutHeader.Version == FMinesweeperSnapshot::Version;
+	}
+
+	// Mapped files are only guaranteed to be aligned to the start of the file, so words are copied out rather than cast
+	static uint64 ReadWord(const uint8* Words, int32 WordIndex)
+	{
+		uint64 Word;
+		FMemory::Memcpy(&Word, Words + WordIndex * sizeof(uint64), sizeof(uint64));
+		return Word;
+	}
+
+	template <typename T>
+	static void Append(TArray<uint8>& Data, const T* Items, int32 Num)
+	{
+		Data.Append(reinterpret_cast<const uint8*>(Items), Num * sizeof(T));
+	}
+
+	// Byte I of SpreadBits(B) is 1 if bit I of B is set, which turns a byte of a plane into 8 cells in one go
+	static const uint64* GetSpreadBits()
+	{
+		static const TArray<uint64> SpreadBits = []()
+		{
+			TArray<uint64> Table;
+			Table.SetNumZeroed(256);
+			for (int32 Byte = 0; Byte < 256; Byte++)
+			{
+				for (int32 Bit = 0; Bit < 8; Bit++)
+				{
+					Table[Byte] |= uint64((Byte >> Bit) & 1) << (Bit * 8);
+				}
+			}
+			return Table;
+		}();
+
+		return SpreadBits.GetData();
+	}
+
+	// The reverse of SpreadBits: bit I of the result is the lowest bit of byte I, so 8 cells become a byte of a plane
+	static uint8 GatherBits(uint64 Bytes)
+	{
+		return static_cast<uint8>(((Bytes & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56);
+	}
+
+	/* Call Visitor with the index of every bit set in the plane, skipping a word at a time where nothing is set */
+	template <typename VisitorType>
+	static void ForEachSetBit(const uint8* Words, int32 NumWords, VisitorType Visitor)
+	{
+		for (int32 WordIndex = 0; WordIndex < NumWords; WordIndex++)
+		{
+			for (uint64 Word = ReadWord(Words, WordIndex); Word != 0; Word &= Word - 1)
+			{
+				Visitor(WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word)));
+			}
+		}
+	}
+}
+
+void FMinesweeperSnapshot::Save(const FMinesweeperBoard& Board, TArray<uint8>& OutData)
+{
+	using namespace MinesweeperSnapshot;
+
+	const int32 NumCells = Board.Num();
+	const int32 NumWords = FMath::DivideAndRoundUp(NumCells, 64);
+
+	TArray<uint64> Planes[NumPlanes];
+	for (TArray<uint64>& Plane : Planes)
+	{
+		Plane.SetNumZeroed(NumWords);
+	}
+
+	// Cells are a byte each, so 8 of them are read as a word and each state is gathered into a byte of its plane
+	static constexpr uint8 PlaneBits[NumPlanes] = { FCellData::MineBit, FCellData::FlaggedBit, FCellData::ActivatedBit };
+	const uint8* Cells = reinterpret_cast<const uint8*>(Board.MinesData.GetData());
+
+	for (int32 Group = 0; Group * 8 < NumCells; Group++)
+	{
+		uint64 Bytes = 0;
+		FMemory::Memcpy(&Bytes, Cells + Group * 8, FMath::Min(NumCells - Group * 8, 8));
+
+		for (int32 PlaneIndex = 0; PlaneIndex < NumPlanes; PlaneIndex++)
+		{
+			reinterpret_cast<uint8*>(Planes[PlaneIndex].GetData())[Group] = GatherBits(Bytes / PlaneBits[PlaneIndex]);
+		}
+	}
+
+	FHeader Header = MakeHeader(EKind::Board);
+	Header.bCanPlay = !Board.HasLost();
+	Header.Width = Board.GetWidth();
+	Header.Height = Board.GetHeight();
+	Header.MinesCount = Board.GetMinesCount();
+	Header.Seed = Board.GetSeed();
+
+	for (int32 PlaneIndex = 0; PlaneIndex < NumPlanes; PlaneIndex++)
+	{
+		const bool bEmpty = !Planes[PlaneIndex].ContainsByPredicate([](uint64 Word) { return Word != 0; });
+		Header.PlaneEncodings[PlaneIndex] = static_cast<uint8>(bEmpty ? EPlaneEncoding::Empty : EPlaneEncoding::Bits);
+	}
+
+	OutData.Reset();
+	Append(OutData, &Header, 1);
+	for (int32 PlaneIndex = 0; PlaneIndex < NumPlanes; PlaneIndex++)
+	{
+		if (Header.PlaneEncodings[PlaneIndex] == static_cast<uint8>(EPlaneEncoding::Bits))
+		{
+			Append(OutData, Planes[PlaneIndex].GetData(), NumWords);
+		}
+	}
+}
+
+bool FMinesweeperSnapshot::Load(TArrayView<const uint8> Data, FMinesweeperBoard& OutBoard)
+{
+	using namespace MinesweeperSnapshot;
+
+	FHeader Header;
+	if (!ReadHeader(Data, Header) || Header.Kind != static_cast<uint8>(EKind::Board))
+	{
+		return false;
+	}
+
+	// The same limits FMinesweeperBoard::GenerateMinesData works within
+	const int64 NumCells = int64(Header.Width) * Header.Height;
+	if (Header.Width < 1 || Header.Height < 1 || NumCells > MAX_int32 || Header.MinesCount < 0 || Header.MinesCount >= NumCells)
+	{
+		return false;
+	}
+
+	const int32 NumWords = FMath::DivideAndRoundUp(static_cast<int32>(NumCells), 64);
+
+	// Find where each plane starts, and make sure the data holds exactly the planes the header says it does
+	const uint8* Planes[NumPlanes] = {};
+	int64 Offset = sizeof(FHeader);
+	for (int32 PlaneIndex = 0; PlaneIndex < NumPlanes; PlaneIndex++)
+	{
+		const EPlaneEncoding Encoding = static_cast<EPlaneEncoding>(Header.PlaneEncodings[PlaneIndex]);
+		if (Encoding == EPlaneEncoding::Bits)
+		{
+			Planes[PlaneIndex] = Data.GetData() + Offset;
+			Offset += int64(NumWords) * sizeof(uint64);
+		}
+		else if (Encoding != EPlaneEncoding::Empty)
+		{
+			return false;
+		}
+	}
+
+	if (Offset != Data.Num())
+	{
+		return false;
+	}
+
+	// Mines must add up to the board's count, and nothing may be set past the last cell.
+	// The board's counters come from the same pass, which is far cheaper than counting the cells once they're filled in
+	int64 NumMines = 0;
+	int64 NumFlags = 0;
+	int64 NumRevealedSafeCells = 0;
+	for (int32 WordIndex = 0; WordIndex < NumWords; WordIndex++)
+	{
+		const uint64 Mines = Planes[MinePlane] != nullptr ? ReadWord(Planes[MinePlane], WordIndex) : 0;
+		const uint64 Revealed = Planes[RevealedPlane] != nullptr ? ReadWord(Planes[RevealedPlane], WordIndex) : 0;
+
+		NumMines += FMath::CountBits(Mines);
+		NumFlags += Planes[FlagPlane] != nullptr ? FMath::CountBits(ReadWord(Planes[FlagPlane], WordIndex)) : 0;
+		NumRevealedSafeCells += FMath::CountBits(Revealed & ~Mines);
+	}
+
+	if (NumMines != Header.MinesCount)
+	{
+		return false;
+	}
+
+	const uint32 UsedBitsInLastWord = static_cast<uint32>(NumCells & 63);
+	for (const uint8* Plane : Planes)
+	{
+		if (Plane != nullptr && UsedBitsInLastWord != 0 && (ReadWord(Plane, NumWords - 1) >> UsedBitsInLastWord) != 0)
+		{
+			return false;
+		}
+	}
+
+	OutBoard.Width = Header.Width;
+	OutBoard.Height = Header.Height;
+	OutBoard.MinesCount = static_cast<int32>(Header.MinesCount);
+	OutBoard.bCanPlay = Header.bCanPlay != 0;
+	OutBoard.NumRevealedSafeCells = static_cast<int32>(NumRevealedSafeCells);
+	OutBoard.NumFlags = static_cast<int32>(NumFlags);
+	OutBoard.RandomStream.Initialize(Header.Seed);
+
+	// Reset rather than Empty, so that loading over a board of the same size or larger reuses its allocation.
+	// Every cell is written below, so there's no need to zero them first
+	OutBoard.MinesData.Reset();
+	OutBoard.MinesData.SetNumUninitialized(static_cast<int32>(NumCells));
+	OutBoard.RevealQueue.Reset();
+	OutBoard.ClearJournal();
+
+	// Each byte of a plane is spread over 8 cells, and the planes are combined so every cell is written exactly once
+	static constexpr uint8 PlaneBits[NumPlanes] = { FCellData::MineBit, FCellData::FlaggedBit, FCellData::ActivatedBit };
+	const uint64* SpreadBits = GetSpreadBits();
+	uint8* Cells = reinterpret_cast<uint8*>(OutBoard.MinesData.GetData());
+
+	for (int32 Group = 0; Group * 8 < NumCells; Group++)
+	{
+		uint64 Bytes = 0;
+		for (int32 PlaneIndex = 0; PlaneIndex < NumPlanes; PlaneIndex++)
+		{
+			if (Planes[PlaneIndex] != nullptr)
+			{
+				Bytes |= SpreadBits[Planes[PlaneIndex][Group]] * PlaneBits[PlaneIndex];
+			}
+		}
+
+		FMemory::Memcpy(Cells + Group * 8, &Bytes, FMath::Min(static_cast<int32>(NumCells) - Group * 8, 8));
+	}
+
+	OutBoard.ComputeNearbyMinesCounts();
+	OutBoard.UpdateMemoryStats();
+	OutBoard.BoardChangedEvent.Broadcast();
+
+	return true;
+}
+
+void FMinesweeperSnapshot::Save(const FMinesweeperChunkedBoard& Board, TArray<uint8>& OutData)
+{
+	using namespace MinesweeperSnapshot;
+
+	// Untouched chunks are exactly what the seed generates, so only the ones the player changed are stored.
+	// They're sorted so that the same board always saves to the same bytes
+	TArray<FIntPoint> TouchedChunks;
+	for (const TPair<FIntPoint, TUniquePtr<FMinesweeperChunkedBoard::FChunk>>& Pair : Board.Chunks)
+	{
+		if (Pair.Value->bTouched)
+		{
+			TouchedChunks.Add(Pair.Key);
+		}
+	}
+
+	TouchedChunks.Sort([](const FIntPoint& A, const FIntPoint& B)
+	{
+		return A.Y != B.Y ? A.Y < B.Y : A.X < B.X;
+	});
+
+	FHeader Header = MakeHeader(EKind::ChunkedBoard);
+	Header.bCanPlay = !Board.HasLost();
+	Header.Width = Board.GetWidth();
+	Header.Height = Board.GetHeight();
+	Header.MinesCount = Board.GetMinesCount();
+	Header.Seed = Board.GetSeed();
+	Header.MineThreshold = Board.MineThreshold;
+	Header.NumChunks = TouchedChunks.Num();
+	Header.bInfinite = Board.IsInfinite();
+
+	OutData.Reset(sizeof(FHeader) + TouchedChunks.Num() * ChunkRecordSize);
+	Append(OutData, &Header, 1);
+
+	uint64 FlagWords[WordsPerChunkPlane];
+	uint64 RevealedWords[WordsPerChunkPlane];
+
+	for (const FIntPoint& ChunkCoord : TouchedChunks)
+	{
+		const TArray<FCellData>& Cells = Board.Chunks.FindChecked(ChunkCoord)->Cells;
+
+		FMemory::Memzero(FlagWords);
+		FMemory::Memzero(RevealedWords);
+		for (int32 CellIndex = 0; CellIndex < Cells.Num(); CellIndex++)
+		{
+			const uint64 Bit = 1ull << (CellIndex & 63);
+			FlagWords[CellIndex >> 6] |= Cells[CellIndex].IsFlagged() ? Bit : 0;
+			RevealedWords[CellIndex >> 6] |= Cells[CellIndex].WasActivated() ? Bit : 0;
+		}
+
+		const int32 Coord[2] = { ChunkCoord.X, ChunkCoord.Y };
+		Append(OutData, Coord, 2);
+		Append(OutData, FlagWords, WordsPerChunkPlane);
+		Append(OutData, RevealedWords, WordsPerChunkPlane);
+	}
+}
+
+bool FMinesweeperSnapshot::Load(TArrayView<const uint8> Data, FMinesweeperChunkedBoard& OutBoard)
+{
+	using namespace MinesweeperSnapshot;
+
+	FHeader Header;
+	if (!ReadHeader(Data, Header) || Header.Kind != static_cast<uint8>(EKind::ChunkedBoard))
+	{
+		return false;
+	}
+
+	// The same limits the chunked board generates within
+	const int64 NumCells = int64(Header.Width) * Header.Height;
+	const bool bValidSize = Header.bInfinite
+		? Header.Width == FMinesweeperChunkedBoard::InfiniteSize && Header.Height == FMinesweeperChunkedBoard::InfiniteSize
+		: Header.Width >= 1 && Header.Height >= 1 && Header.MinesCount >= 0 && Header.MinesCount < NumCells;
+
+	if (!bValidSize || Header.NumChunks < 0 || sizeof(FHeader) + int64(Header.NumChunks) * ChunkRecordSize != Data.Num())
+	{
+		return false;
+	}
+
+	// Every chunk must be on the board, and only be stored once
+	const FIntPoint NumChunks(
+		FMath::DivideAndRoundUp(Header.Width, FMinesweeperChunkedBoard::ChunkSize),
+		FMath::DivideAndRoundUp(Header.Height, FMinesweeperChunkedBoard::ChunkSize));
+
+	TSet<FIntPoint> ChunkCoords;
+	ChunkCoords.Reserve(Header.NumChunks);
+
+	for (int32 ChunkIndex = 0; ChunkIndex < Header.NumChunks; ChunkIndex++)
+	{
+		int32 Coord[2];
+		FMemory::Memcpy(Coord, Data.GetData() + sizeof(FHeader) + int64(ChunkIndex) * ChunkRecordSize, sizeof(Coord));
+
+		bool bAlreadyInSet = false;
+		ChunkCoords.Add(FIntPoint(Coord[0], Coord[1]), &bAlreadyInSet);
+
+		if (bAlreadyInSet || Coord[0] < 0 || Coord[0] >= NumChunks.X || Coord[1] < 0 || Coord[1] >= NumChunks.Y)
+		{
+			return false;
+		}
+	}
+
+	OutBoard.ResetBoard(Header.Width, Header.Height, Header.Seed);
+	OutBoard.MinesCount = Header.MinesCount;
+	OutBoard.bInfinite = Header.bInfinite != 0;
+	OutBoard.MineThreshold = Header.MineThreshold;
+	OutBoard.bCanPlay = Header.bCanPlay != 0;
+
+	// Each chunk is generated from the seed as it would be in play, and the player's changes are put back on top
+	for (int32 ChunkIndex = 0; ChunkIndex < Header.NumChunks; ChunkIndex++)
+	{
+		const uint8* Record = Data.GetData() + sizeof(FHeader) + int64(ChunkIndex) * ChunkRecordSize;
+
+		int32 Coord[2];
+		FMemory::Memcpy(Coord, Record, sizeof(Coord));
+		const FIntPoint ChunkCoord(Coord[0], Coord[1]);
+		const FIntPoint ChunkCellsSize = OutBoard.GetChunkCellsSize(ChunkCoord);
+
+		TUniquePtr<FMinesweeperChunkedBoard::FChunk> Chunk = MakeUnique<FMinesweeperChunkedBoard::FChunk>();
+		OutBoard.GenerateChunk(ChunkCoord, *Chunk);
+		Chunk->bTouched = true;
+		Chunk->LastUsed = ++OutBoard.UseCounter;
+
+		// Cells past the edge of the board are never used, so anything set on them is ignored
+		TArray<FCellData>& Cells = Chunk->Cells;
+		auto IsOnBoard = [&ChunkCellsSize](int32 CellIndex)
+		{
+			return CellIndex % FMinesweeperChunkedBoard::ChunkSize < ChunkCellsSize.X && CellIndex / FMinesweeperChunkedBoard::ChunkSize < ChunkCellsSize.Y;
+		};
+
+		const uint8* FlagWords = Record + sizeof(Coord);
+		const uint8* RevealedWords = FlagWords + WordsPerChunkPlane * sizeof(uint64);
+
+		// Only touched chunks can hold flagged or revealed cells, so counting them here counts the whole board
+		ForEachSetBit(FlagWords, WordsPerChunkPlane, [&](int32 CellIndex)
+		{
+			if (IsOnBoard(CellIndex))
+			{
+				Cells[CellIndex].SetIsFlagged(true);
+				OutBoard.NumFlags++;
+			}
+		});
+
+		ForEachSetBit(RevealedWords, WordsPerChunkPlane, [&](int32 CellIndex)
+		{
+			if (IsOnBoard(CellIndex))
+			{
+				Cells[CellIndex].SetActivated();
+				OutBoard.NumRevealedSafeCells += Cells[CellIndex].IsMine() ? 0 : 1;
+			}
+		});
+
+		OutBoard.Chunks.Add(ChunkCoord, MoveTemp(Chunk));
+	}
+
+	OutBoard.UpdateMemoryStats();
+	OutBoard.BoardChangedEvent.Broadcast();
+
+	return true;
+}
+
+bool FMinesweeperSnapshot::SaveToFile(const FMinesweeperBoard& Board, const TCHAR* Filename)
+{
+	TArray<uint8> Data;
+	Save(Board, Data);
+	return FFileHelper::SaveArrayToFile(Data, Filename);
+}
+
+bool FMinesweeperSnapshot::SaveToFile(const FMinesweeperChunkedBoard& Board, const TCHAR* Filename)
+{
+	TArray<uint8> Data;
+	Save(Board, Data);
+	return FFileHelper::SaveArrayToFile(Data, Filename);
+}
+
+bool FMinesweeperSnapshot::ReadFile(const TCHAR* Filename, TFunctionRef<bool(TArrayView<const uint8>)> Visitor)
+{
+	// Not every platform file can map files, files inside a pak can't be mapped at all, so we fall back to reading them.
+	// The region has to be unmapped before the file is closed, which the order they're declared in takes care of
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(Filename));
+	if (MappedFile.IsValid())
+	{
+		TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile->MapRegion());
+		if (MappedRegion.IsValid() && MappedRegion->GetMappedSize() <= MAX_int32)
+		{
+			return Visitor(TArrayView<const uint8>(MappedRegion->GetMappedPtr(), static_cast<int32>(MappedRegion->GetMappedSize())));
+		}
+	}
+
+	TArray<uint8> Data;
+	return FFileHelper::LoadFileToArray(Data, Filename, FILEREAD_Silent) && Visitor(Data);
+}
+
+bool FMinesweeperSnapshot::IsChunkedSnapshot(TArrayView<const uint8> Data)
+{
+	using namespace MinesweeperSnapshot;
+
+	FHeader Header;
+	return ReadHeader(Data, Header) && Header.Kind == static_cast<uint8>(EKind::ChunkedBoard);
+}
+
+#undef SNAPSHOT_MAGIC
@@ -0,0 +1,372 @@
+﻿#include "MinesweeperSolver.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperStats.h"
+
+FMinesweeperSolver::FMinesweeperSolver(FMinesweeperBoard& InBoard)
+	: Board(InBoard)
+{
+	Board.OnCellsChanged().AddRaw(this, &FMinesweeperSolver::HandleCellsChanged);
+	Board.OnBoardChanged().AddRaw(this, &FMinesweeperSolver::HandleBoardChanged);
+
+	Reset();
+}
+
+FMinesweeperSolver::~FMinesweeperSolver()
+{
+	Board.OnCellsChanged().RemoveAll(this);
+	Board.OnBoardChanged().RemoveAll(this);
+}
+
+void FMinesweeperSolver::Reset()
+{
+	const int32 NumCells = Board.Num();
+
+	Knowledge.Reset();
+	Knowledge.SetNumZeroed(NumCells);
+	Reasons.Reset();
+	Reasons.SetNum(NumCells);
+	IsQueued.Reset();
+	IsQueued.SetNumZeroed(NumCells);
+	QueuedConstraints.Reset();
+	SafeCells.Reset();
+	MineCells.Reset();
+
+	for (int32 Idx = 0; Idx < NumCells; Idx++)
+	{
+		if (IsRevealed(Idx))
+		{
+			Knowledge[Idx] = EMinesweeperCellKnowledge::Safe;
+			QueueConstraint(Idx);
+		}
+	}
+}
+
+void FMinesweeperSolver::HandleCellsChanged(TArrayView<const int32> ChangedCells)
+{
+	ForgottenCells.Reset();
+
+	// Flags are also reported as changes, but they don't tell us anything so hidden cells are only of interest if an undo
+	// hid them again, which is the only way a cell we knew about from seeing it can become hidden
+	for (const int32 Idx : ChangedCells)
+	{
+		if (IsRevealed(Idx))
+		{
+			// A cell we already knew was safe has only gained a number. Anything else also shrinks its neighbours' constraints
+			if (Knowledge[Idx] != EMinesweeperCellKnowledge::Safe)
+			{
+				Knowledge[Idx] = EMinesweeperCellKnowledge::Safe;
+				QueueConstraintsAround(Idx);
+			}
+
+			// We know about it from seeing it now, whatever we deduced before
+			Reasons[Idx] = FDeductionReason();
+			QueueConstraint(Idx);
+		}
+		else if (Knowledge[Idx] == EMinesweeperCellKnowledge::Safe && Reasons[Idx].Constraint == INDEX_NONE)
+		{
+			ForgottenCells.Add(Idx);
+		}
+	}
+
+	if (ForgottenCells.Num() == 0)
+	{
+		return;
+	}
+
+	// Taking back a cell looks at a few dozen cells around it, so an undo which hid a large part of the board is cheaper
+	// to start over from
+	if (ForgottenCells.Num() > Board.Num() / 32)
+	{
+		Reset();
+		return;
+	}
+
+	ForgetCells();
+}
+
+void FMinesweeperSolver::ForgetCells()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperSolver::ForgetCells);
+
+	for (const int32 Idx : ForgottenCells)
+	{
+		Knowledge[Idx] = EMinesweeperCellKnowledge::Unknown;
+	}
+
+	// Every deduction was made from one or two constraints, using what was known about the cells around them. So once we
+	// stop knowing about a cell, the deductions made from any constraint around it go too, and so on from each of those.
+	// A deduction is at most a cell from its constraint and its constraint at most 2 from the other, so looking 4 cells
+	// around the forgotten cell finds every deduction made from a constraint next to it
+	for (int32 ForgottenIndex = 0; ForgottenIndex < ForgottenCells.Num(); ForgottenIndex++)
+	{
+		const int32 Idx = ForgottenCells[ForgottenIndex];
+		const int32 Row = Board.GetRow(Idx);
+		const int32 Col = Board.GetCol(Idx);
+
+		auto IsNextToForgotten = [this, Row, Col](int32 Constraint)
+		{
+			return Constraint != INDEX_NONE && FMath::Abs(Board.GetRow(Constraint) - Row) <= 1 && FMath::Abs(Board.GetCol(Constraint) - Col) <= 1;
+		};
+
+		for (int32 OtherRow = FMath::Max(Row - 4, 0); OtherRow <= FMath::Min(Row + 4, Board.GetHeight() - 1); OtherRow++)
+		{
+			for (int32 OtherCol = FMath::Max(Col - 4, 0); OtherCol <= FMath::Min(Col + 4, Board.GetWidth() - 1); OtherCol++)
+			{
+				const int32 OtherIdx = Board.GetIndex(OtherRow, OtherCol);
+				const FDeductionReason& Reason = Reasons[OtherIdx];
+
+				if (Knowledge[OtherIdx] != EMinesweeperCellKnowledge::Unknown && !IsRevealed(OtherIdx)
+					&& (IsNextToForgotten(Reason.Constraint) || IsNextToForgotten(Reason.OtherConstraint)))
+				{
+					Knowledge[OtherIdx] = EMinesweeperCellKnowledge::Unknown;
+					Reasons[OtherIdx] = FDeductionReason();
+					ForgottenCells.Add(OtherIdx);
+				}
+			}
+		}
+	}
+
+	// Every constraint which counted on a forgotten cell, or could be paired with one that did, is looked at again
+	for (const int32 Idx : ForgottenCells)
+	{
+		const int32 Row = Board.GetRow(Idx);
+		const int32 Col = Board.GetCol(Idx);
+
+		for (int32 OtherRow = FMath::Max(Row - 3, 0); OtherRow <= FMath::Min(Row + 3, Board.GetHeight() - 1); OtherRow++)
+		{
+			for (int32 OtherCol = FMath::Max(Col - 3, 0); OtherCol <= FMath::Min(Col + 3, Board.GetWidth() - 1); OtherCol++)
+			{
+				const int32 OtherIdx = Board.GetIndex(OtherRow, OtherCol);
+				if (IsRevealed(OtherIdx))
+				{
+					QueueConstraint(OtherIdx);
+				}
+			}
+		}
+	}
+
+	SafeCells.RemoveAllSwap([this](int32 Idx) { return Knowledge[Idx] != EMinesweeperCellKnowledge::Safe; }, false);
+	MineCells.RemoveAllSwap([this](int32 Idx) { return Knowledge[Idx] != EMinesweeperCellKnowledge::Mine; }, false);
+}
+
+void FMinesweeperSolver::HandleBoardChanged()
+{
+	Reset();
+}
+
+bool FMinesweeperSolver::Solve()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperSolve);
+
+	bool bDeducedAnything = false;
+
+	// Deductions queue the constraints around them, so this keeps going until nothing more can be deduced
+	while (QueuedConstraints.Num() > 0)
+	{
+		const int32 Idx = QueuedConstraints.Pop(false);
+		IsQueued[Idx] = false;
+
+		bDeducedAnything |= SolveConstraint(Idx);
+	}
+
+	// Safe cells which have been revealed since they were deduced aren't of any more use to anyone
+	SafeCells.RemoveAllSwap([this](int32 Idx) { return IsRevealed(Idx); }, false);
+
+	return bDeducedAnything;
+}
+
+bool FMinesweeperSolver::SolveConstraint(int32 Idx)
+{
+	FCellList UnknownCells;
+	const int32 Mines = GetConstraint(Idx, UnknownCells);
+
+	if (UnknownCells.Num() == 0)
+	{
+		return false;
+	}
+
+	// Single cell rules: every mine is already accounted for, or every unknown cell must be a mine
+	if (Mines == 0 || Mines == UnknownCells.Num())
+	{
+		const EMinesweeperCellKnowledge NewKnowledge = Mines == 0 ? EMinesweeperCellKnowledge::Safe : EMinesweeperCellKnowledge::Mine;
+		for (const int32 UnknownCell : UnknownCells)
+		{
+			Deduce(UnknownCell, NewKnowledge, FDeductionReason(Idx, INDEX_NONE));
+		}
+
+		return true;
+	}
+
+	// Pairwise rules, against every other revealed cell within 2 cells, as those are the only ones which can share unknown cells
+	const int32 Row = Board.GetRow(Idx);
+	const int32 Col = Board.GetCol(Idx);
+
+	for (int32 OtherRow = FMath::Max(Row - 2, 0); OtherRow <= FMath::Min(Row + 2, Board.GetHeight() - 1); OtherRow++)
+	{
+		for (int32 OtherCol = FMath::Max(Col - 2, 0); OtherCol <= FMath::Min(Col + 2, Board.GetWidth() - 1); OtherCol++)
+		{
+			const int32 OtherIdx = Board.GetIndex(OtherRow, OtherCol);
+			if (OtherIdx == Idx || !IsRevealed(OtherIdx))
+			{
+				continue;
+			}
+
+			FCellList OtherUnknownCells;
+			const int32 OtherMines = GetConstraint(OtherIdx, OtherUnknownCells);
+
+			const FDeductionReason Reason(Idx, OtherIdx);
+			if (SolvePair(UnknownCells, Mines, OtherUnknownCells, OtherMines, Reason) || SolvePair(OtherUnknownCells, OtherMines, UnknownCells, Mines, Reason))
+			{
+				// Look at ourselves again with what we now know, as we may pair up with another constraint as well
+				QueueConstraint(Idx);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool FMinesweeperSolver::SolvePair(const FCellList& CellsA, int32 MinesA, const FCellList& CellsB, int32 MinesB, const FDeductionReason& Reason)
+{
+	// The cells A and B share can hold at most MinesA mines, so the cells only B has hold at least MinesB - MinesA.
+	// If that's all of them, they're all mines, the shared cells hold exactly MinesA, and the cells only A has are safe.
+	FCellList OnlyA;
+	FCellList OnlyB;
+	int32 NumShared = 0;
+
+	for (const int32 Cell : CellsA)
+	{
+		if (CellsB.Contains(Cell))
+		{
+			NumShared++;
+		}
+		else
+		{
+			OnlyA.Add(Cell);
+		}
+	}
+
+	if (NumShared == 0)
+	{
+		return false;
+	}
+
+	for (const int32 Cell : CellsB)
+	{
+		if (!CellsA.Contains(Cell))
+		{
+			OnlyB.Add(Cell);
+		}
+	}
+
+	if ((OnlyA.Num() == 0 && OnlyB.Num() == 0) || MinesB - MinesA != OnlyB.Num())
+	{
+		return false;
+	}
+
+	for (const int32 Cell : OnlyB)
+	{
+		Deduce(Cell, EMinesweeperCellKnowledge::Mine, Reason);
+	}
+
+	for (const int32 Cell : OnlyA)
+	{
+		Deduce(Cell, EMinesweeperCellKnowledge::Safe, Reason);
+	}
+
+	return true;
+}
+
+int32 FMinesweeperSolver::GetConstraint(int32 Idx, FCellList& OutUnknownCells) const
+{
+	OutUnknownCells.Reset();
+	int32 Mines = Board.GetCell(Idx).GetNearbyMinesCount();
+
+	const int32 Row = Board.GetRow(Idx);
+	const int32 Col = Board.GetCol(Idx);
+
+	for (int32 AdjacentRow = FMath::Max(Row - 1, 0); AdjacentRow <= FMath::Min(Row + 1, Board.GetHeight() - 1); AdjacentRow++)
+	{
+		for (int32 AdjacentCol = FMath::Max(Col - 1, 0); AdjacentCol <= FMath::Min(Col + 1, Board.GetWidth() - 1); AdjacentCol++)
+		{
+			const int32 AdjacentIdx = Board.GetIndex(AdjacentRow, AdjacentCol);
+			if (Knowledge[AdjacentIdx] == EMinesweeperCellKnowledge::Mine)
+			{
+				Mines--;
+			}
+			else if (Knowledge[AdjacentIdx] == EMinesweeperCellKnowledge::Unknown)
+			{
+				OutUnknownCells.Add(AdjacentIdx);
+			}
+		}
+	}
+
+	return Mines;
+}
+
+void FMinesweeperSolver::Deduce(int32 Idx, EMinesweeperCellKnowledge NewKnowledge, const FDeductionReason& Reason)
+{
+	if (Knowledge[Idx] != EMinesweeperCellKnowledge::Unknown)
+	{
+		return;
+	}
+
+	Knowledge[Idx] = NewKnowledge;
+	Reasons[Idx] = Reason;
+	(NewKnowledge == EMinesweeperCellKnowledge::Mine ? MineCells : SafeCells).Add(Idx);
+
+	QueueConstraintsAround(Idx);
+}
+
+void FMinesweeperSolver::QueueConstraint(int32 Idx)
+{
+	// Cells without a number around them are queued too, as a flag can stop a cascade next to one and leave a cell it
+	// proves is safe hidden
+	if (!IsQueued[Idx])
+	{
+		IsQueued[Idx] = true;
+		QueuedConstraints.Add(Idx);
+	}
+}
+
+void FMinesweeperSolver::QueueConstraintsAround(int32 Idx)
+{
+	const int32 Row = Board.GetRow(Idx);
+	const int32 Col = Board.GetCol(Idx);
+
+	for (int32 AdjacentRow = FMath::Max(Row - 1, 0); AdjacentRow <= FMath::Min(Row + 1, Board.GetHeight() - 1); AdjacentRow++)
+	{
+		for (int32 AdjacentCol = FMath::Max(Col - 1, 0); AdjacentCol <= FMath::Min(Col + 1, Board.GetWidth() - 1); AdjacentCol++)
+		{
+			const int32 AdjacentIdx = Board.GetIndex(AdjacentRow, AdjacentCol);
+			if (IsRevealed(AdjacentIdx))
+			{
+				QueueConstraint(AdjacentIdx);
+			}
+		}
+	}
+}
+
+bool FMinesweeperSolver::IsRevealed(int32 Idx) const
+{
+	return Board.GetCell(Idx).WasActivated();
+}
+
+EMinesweeperCellKnowledge FMinesweeperSolver::GetKnowledge(int32 Idx) const
+{
+	check(Idx < Knowledge.Num())
+
+	return Knowledge[Idx];
+}
+
+const TArray<int32>& FMinesweeperSolver::GetSafeCells() const
+{
+	return SafeCells;
+}
+
+const TArray<int32>& FMinesweeperSolver::GetMineCells() const
+{
+	return MineCells;
+}
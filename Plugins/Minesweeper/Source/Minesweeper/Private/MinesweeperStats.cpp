@@ -0,0 +1,22 @@
+﻿#include "MinesweeperStats.h"
+
+DEFINE_STAT(STAT_MinesweeperGenerateGrid);
+DEFINE_STAT(STAT_MinesweeperGenerateMinesData);
+DEFINE_STAT(STAT_MinesweeperCountNearbyMines);
+DEFINE_STAT(STAT_MinesweeperGenerateChunk);
+DEFINE_STAT(STAT_MinesweeperActivateCell);
+DEFINE_STAT(STAT_MinesweeperApplyMoves);
+DEFINE_STAT(STAT_MinesweeperSolve);
+DEFINE_STAT(STAT_MinesweeperComputeProbabilities);
+DEFINE_STAT(STAT_MinesweeperFindNoGuessingSeed);
+DEFINE_STAT(STAT_MinesweeperPaintBoard);
+
+DEFINE_STAT(STAT_MinesweeperLastCascadeSize);
+DEFINE_STAT(STAT_MinesweeperBoardViews);
+
+DEFINE_STAT(STAT_MinesweeperCellsRevealed);
+DEFINE_STAT(STAT_MinesweeperMovesApplied);
+DEFINE_STAT(STAT_MinesweeperCellsPainted);
+
+DEFINE_STAT(STAT_MinesweeperBoardMemory);
+DEFINE_STAT(STAT_MinesweeperBoardViewMemory);
@@ -1,488 +1,1121 @@
-﻿#include "SMinesweeper.h"
-
-#include "SlateOptMacros.h"
-#include "Widgets/Input/SSpinBox.h"
-#include "Widgets/Layout/SUniformGridPanel.h"
-
-#include "SRightClickableButton.h"
-
-#define LOCTEXT_NAMESPACE "SMinesweeper"
-
-#define DEFAULT_WIDTH 10
-#define DEFAULT_HEIGHT 10
-#define DEFAULT_NUM_MINES 25
-#define START_WITH_PLAYER_HINT true
-
-static FSlateFontInfo ExtraLargeLayoutFont = FCoreStyle::GetDefaultFontStyle("Regular", 26);
-static FSlateFontInfo LargeLayoutFont = FCoreStyle::GetDefaultFontStyle("Regular", 16);
-static FSlateFontInfo MediumLayoutFont = FCoreStyle::GetDefaultFontStyle("Regular", 14);
-
-void SMinesweeper::Construct(const FArguments& InArgs)
-{
-	ChildSlot
-	[
-		SNew(SVerticalBox)
-		+SVerticalBox::Slot()
-		.Padding(5)
-		.AutoHeight()
-		[
-			SNew(SHorizontalBox)
-			+ SHorizontalBox::Slot().Padding(10)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(STextBlock)
-				.Text(LOCTEXT("Minesweeper-Width", "Width"))
-				.Font(LargeLayoutFont)
-			]
-			+ SHorizontalBox::Slot().Padding(5)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(SSpinBox<int>)
-				.Font(LargeLayoutFont)
-				.MinDesiredWidth(48.f)
-				.MinValue(3)
-				.MaxValue(20)
-				.MinSliderValue(TAttribute<TOptional<int>>(1))
-				.MaxSliderValue(TAttribute<TOptional<int>>(20))
-				.Delta(1)
-				.Value(this, &SMinesweeper::GetDesiredWidth)
-				.OnValueChanged(this, &SMinesweeper::OnDesiredWidthChanged)
-			]
-			+ SHorizontalBox::Slot().Padding(10)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(STextBlock)
-				.Text(LOCTEXT("Minesweeper-Height", "Height"))
-				.Font(LargeLayoutFont)
-			]
-			+ SHorizontalBox::Slot().Padding(5)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(SSpinBox<int>)
-				.Font(LargeLayoutFont)
-				.MinDesiredWidth(48.f)
-				.MinValue(3)
-				.MaxValue(20)
-				.MinSliderValue(TAttribute<TOptional<int>>(1))
-				.MaxSliderValue(TAttribute<TOptional<int>>(20))
-				.Delta(1)
-				.Value(this, &SMinesweeper::GetDesiredHeight)
-				.OnValueChanged(this, &SMinesweeper::OnDesiredHeightChanged)
-			]
-			+ SHorizontalBox::Slot().Padding(10)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(STextBlock)
-				.Text(LOCTEXT("Minesweeper-NumMines", "Number of Mines"))
-				.Font(LargeLayoutFont)
-			]
-			+ SHorizontalBox::Slot().Padding(5)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(SSpinBox<int>)
-				.Font(LargeLayoutFont)
-				.MinDesiredWidth(64.f)
-				.MinValue(3)
-				.MinSliderValue(TAttribute<TOptional<int>>(1))
-				.Delta(1)
-				.Value(this, &SMinesweeper::GetDesiredMinesNum)
-				.OnValueChanged(this, &SMinesweeper::OnDesiredMinesNumChanged)
-			]
-			+ SHorizontalBox::Slot().Padding(10)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(SVerticalBox)
-				+ SVerticalBox::Slot().Padding(5, 0)
-				.AutoHeight() [
-					SNew(SCheckBox)
-					.IsChecked(this, &SMinesweeper::GetPlayerHintState)
-					.OnCheckStateChanged(this, &SMinesweeper::OnPlayerHintChanged)
-					[
-						SNew(STextBlock).Text(LOCTEXT("Minesweeper-Hint", "Start with Hint"))
-					]
-				]
-				+ SVerticalBox::Slot().Padding(5, 0)
-				.AutoHeight() [
-					SNew(SCheckBox)
-					.IsChecked(this, &SMinesweeper::GetDebugMinesState)
-					.OnCheckStateChanged(this, &SMinesweeper::OnDebugMinesChanged)
-					[
-						SNew(STextBlock).Text(LOCTEXT("Minesweeper-DebugMines", "(Cheat) Show Mines"))
-					]
-				]
-			]
-			+ SHorizontalBox::Slot().Padding(10)
-			.VAlign(VAlign_Center)
-			.AutoWidth()
-			[
-				SNew(SButton)
-				.OnClicked(this, &SMinesweeper::OnGenerateGridClicked)
-				[
-					SNew(STextBlock)
-					.Font(MediumLayoutFont)
-					.Text(LOCTEXT("Minesweeper-NewGame", "New Game"))
-				]
-			]
-		]
-		+ SVerticalBox::Slot()
-		.FillHeight(1)
-		[
-			SNew(SOverlay)
-			+ SOverlay::Slot() [
-				SAssignNew(GridPanel, SUniformGridPanel)
-					.MinDesiredSlotWidth(24.f)
-					.MinDesiredSlotHeight(24.f)
-			]
-			+ SOverlay::Slot()
-			.HAlign(HAlign_Center)
-			.VAlign(VAlign_Center)
-			[
-				SNew(STextBlock)
-				.Visibility_Lambda([this]()
-				{
-					return CanPlay() ? EVisibility::Hidden : EVisibility::Visible;
-				})
-				.Font(ExtraLargeLayoutFont)
-				.Text(LOCTEXT("Minesweeper-GameOver", "Game Over!"))
-			]
-		]
-	];
-
-	// We can start with a player hint by setting this to true
-	// Which will "activate" a non-mine cell randomly on the board (including cascade)
-	OnPlayerHintChanged(START_WITH_PLAYER_HINT ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
-	
-	// Let's set some default values
-	OnDesiredWidthChanged(DEFAULT_WIDTH);
-	OnDesiredHeightChanged(DEFAULT_HEIGHT);
-	OnDesiredMinesNumChanged(DEFAULT_NUM_MINES);
-	GenerateGrid();
-}
-
-TSharedRef<SWidget> SMinesweeper::ConstructCellButton(int32 Idx)
-{
-	TSharedRef<SRightClickableButton> Button = SNew(SRightClickableButton)
-		.IsEnabled_Lambda([this, Idx]()
-		{
-			check(Idx < MinesData.Num())
-			
-			return CanPlay() && MinesData[Idx].GetNearbyMinesCount() == -1;
-		})
-		.OnClicked_Lambda([this, Idx]()
-		{
-			if (CanPlay())
-			{
-				ActivateCell(Idx);
-			}
-			
-			return FReply::Handled();
-		})
-		[
-			SNew(SBox)
-			.HAlign(HAlign_Center)
-			.VAlign(VAlign_Center)
-			.Padding(10)
-			[
-				SNew(STextBlock)
-				.Font(MediumLayoutFont)
-				.Text_Lambda([this, Idx]()
-				{
-					check(Idx < MinesData.Num())
-
-					const FCellData* Cell = &MinesData[Idx];
-
-					// Reveal mines at the end of a game, or if debug mines
-					// We'll also make sure to display the Flag state if we were flagged
-					if (!CanPlay() || IsDebugMinesEnabled())
-					{
-						if (Cell->IsMine())
-						{
-							if (Cell->IsFlagged())
-							{
-								return FText::FromString("F-M");
-							}
-
-							return FText::FromString("M");
-						}
-					}
-
-					if (Cell->IsFlagged())
-					{
-						return FText::FromString("F");
-					}
-					
-					return Cell->GetNearbyMinesCount() > 0 ? FText::FromString(FString::FromInt(Cell->GetNearbyMinesCount())) : FText();
-				})
-			]
-		];
-
-	Button->SetOnRightMouseButtonClicked(FOnClicked::CreateLambda([this, Idx]()
-	{
-		check(Idx < MinesData.Num())
-		
-		FCellData* Cell = &MinesData[Idx];
-		Cell->SetIsFlagged(!Cell->IsFlagged());
-		
-		return FReply::Handled();
-	}));
-	
-	return Button;
-}
-
-void SMinesweeper::GenerateGrid()
-{
-	bCanPlay = true;
-
-	// Generate our cell data, as well as mine placement
-	int32 StartingPoint = GenerateMinesData();
-	
-	GridPanel->ClearChildren();
-	
-	// We'll generate our buttons, and provide each button with a cell index for reference later
-	for (int32 CellIndex = 0; CellIndex < DesiredHeight * DesiredWidth; CellIndex++)
-	{
-		int32 Row = CellIndex / DesiredWidth;
-		int32 Col = CellIndex % DesiredWidth;
-		
-		GridPanel->AddSlot(Col, Row) [
-			ConstructCellButton(CellIndex)
-		];
-	}
-
-	// We'll give the player a random starting point hint if it's enabled and we actually have one
-	// The scenarios in which we don't have one would be if the grid is entirely filled with mines, which
-	// can happen depending on some tweaks to the control widgets
-	if (IsPlayerHintEnabled() && StartingPoint > -1)
-	{
-		ActivateCell(MinesData[StartingPoint].GetIndex());
-	}
-}
-
-int32 SMinesweeper::GenerateMinesData()
-{
-	MinesData.Empty(DesiredHeight * DesiredWidth);
-
-	// Here's the algorithm we've come up with for mine placement
-	// 1. Store Cell data in a row-major ordered array
-	// 2. Uses a temporary array of pointers of "known not to have a mine" or "clean" cells
-	// 3. For n number of mines we want, we pull from our temporary list, set it as a mine, and then remove it from our temp list
-	// 4. If we still have any clean cells left over,
-	//    return a random index from our clean cells list so that we can provide a player hint if enabled.
-
-	// Temporary array of cell pointers, so that we can randomly pull a cell out
-	// and mark it as a mine
-	TArray<FCellData*> CleanCells;
-
-	// Prefill out cells
-	for (int32 cell = 0; cell < DesiredHeight * DesiredWidth; cell++)
-	{
-		MinesData.Add(FCellData(cell / DesiredWidth, cell % DesiredWidth, cell));
-		CleanCells.Add(&MinesData[cell]);
-	}
-
-	check(DesiredMinesCount < CleanCells.Num());
-
-	// Randomly choose cells to become mines
-	for (int32 i = 0; i < DesiredMinesCount; i++)
-	{
-		int32 randomIndex = FMath::RandRange(0, CleanCells.Num()-1);
-		CleanCells[randomIndex]->SetMine();
-		CleanCells.RemoveAt(randomIndex);
-	}
-
-	// We'll return a starting point that can be used to give the initial mine hint to a player, if we can.
-	// If the entire grid is mines, we can't.
-	if (CleanCells.Num() > 0)
-	{
-		return CleanCells[FMath::RandRange(0, CleanCells.Num() - 1)]->GetIndex();
-	}
-
-	return -1;
-}
-
-int32 SMinesweeper::FindNearbyMinesCount(int32 CellIndex)
-{
-	check(CellIndex < MinesData.Num())
-	const FCellData* CurrentCell = &MinesData[CellIndex];
-	int32 FoundMines = 0;
-	
-	for (int32 i = -1; i < 2; i++)
-	{
-		for (int32 j = -1; j < 2; j++)
-		{
-			int32 AdjacentCellIndex = -1;
-			if (TryGetAdjacentCellIndex(CurrentCell, i, j, AdjacentCellIndex))
-			{
-				if (MinesData[AdjacentCellIndex].IsMine())
-				{
-					FoundMines++;
-				}
-			}
-		}
-	}
-
-	return FoundMines;
-}
-
-void SMinesweeper::ActivateNearbyCells(int32 CellIndex)
-{
-	check(CellIndex < MinesData.Num())
-	const FCellData* CurrentCell = &MinesData[CellIndex];
-
-	for (int32 i = -1; i < 2; i++)
-	{
-		for (int32 j = -1; j < 2; j++)
-		{
-			int32 AdjacentCellIndex = -1;
-			if (TryGetAdjacentCellIndex(CurrentCell, i, j, AdjacentCellIndex))
-			{
-				if (!MinesData[AdjacentCellIndex].IsMine() && !MinesData[AdjacentCellIndex].IsFlagged() && !MinesData[AdjacentCellIndex].WasActivated())
-				{
-					ActivateCell(AdjacentCellIndex);
-				}	
-			}
-		}
-	}
-}
-
-bool SMinesweeper::CanPlay() const
-{
-	return bCanPlay;
-}
-
-void SMinesweeper::ActivateCell(int32 Idx)
-{
-	check(Idx < MinesData.Num())
-	
-	FCellData* Cell = &MinesData[Idx];
-
-	if (Cell->IsFlagged())
-	{
-		return;
-	}
-
-	if (Cell->IsMine())
-	{
-		// We've hit a mine!
-		bCanPlay = false;
-		return;
-	}
-
-	int32 NearbyMinesCount = FindNearbyMinesCount(Idx);
-	Cell->SetNearbyMinesCount(NearbyMinesCount);
-
-	// Cascade outward until we've found nearby mines
-	if (NearbyMinesCount == 0)
-	{
-		ActivateNearbyCells(Idx);
-	}
-}
-
-bool SMinesweeper::TryGetAdjacentCellIndex(const FCellData* CurrentCell, int32 Row, int32 Col, int32& OutIndex) const
-{
-	// Reset out index as the first thing, so it's not forgotten or if code changes, it's guaranteed to be set
-	// by this function
-	OutIndex = -1;
-	
-	// Convert our current cell and the requested row,col to an index
-	int32 Index = (CurrentCell->GetRow() + Row) * DesiredWidth + (CurrentCell->GetCol() + Col);
-	
-	if (Index < 0 || Index >= MinesData.Num())
-	{
-		return false;
-	}
-
-	// Quick bounds check to make sure we didn't wrap
-	if (FMath::Abs(CurrentCell->GetRow() - MinesData[Index].GetRow()) >= 2 || FMath::Abs(CurrentCell->GetCol() - MinesData[Index].GetCol()) >= 2)
-	{
-		return false;
-	}
-
-	OutIndex = Index;
-	return true;
-}
-
-int32 SMinesweeper::GetDesiredWidth() const
-{
-	return DesiredWidth;
-}
-
-void SMinesweeper::OnDesiredWidthChanged(int32 NewVal)
-{
-	DesiredWidth = NewVal;
-
-	// We need to make sure to update Mines as well, if we're changing this value
-	// We'll just pass in the existing value. It could still be valid.
-	OnDesiredMinesNumChanged(DesiredMinesCount);
-}
-
-int32 SMinesweeper::GetDesiredHeight() const
-{
-	return DesiredHeight;
-}
-
-void SMinesweeper::OnDesiredHeightChanged(int32 NewVal)
-{
-	DesiredHeight = NewVal;
-
-	// We need to make sure to update Mines as well, if we're changing this value
-	// We'll just pass in the existing value. It could still be valid.
-	OnDesiredMinesNumChanged(DesiredMinesCount);
-}
-
-int32 SMinesweeper::GetDesiredMinesNum() const
-{
-	return DesiredMinesCount;
-}
-
-void SMinesweeper::OnDesiredMinesNumChanged(int32 NewVal)
-{
-	// Yes, you CAN fill the entire grid with mines.
-	// No, it will not be a fun game.
-	DesiredMinesCount = FMath::Clamp(NewVal, 1, (GetDesiredWidth() * GetDesiredHeight()) - 3);
-}
-
-bool SMinesweeper::IsDebugMinesEnabled() const
-{
-	return DebugMinesState == ECheckBoxState::Checked;
-}
-
-ECheckBoxState SMinesweeper::GetDebugMinesState() const
-{
-	return DebugMinesState;
-}
-
-void SMinesweeper::OnDebugMinesChanged(ECheckBoxState NewState)
-{
-	DebugMinesState = NewState;
-}
-
-bool SMinesweeper::IsPlayerHintEnabled() const
-{
-	return PlayerHintState == ECheckBoxState::Checked;
-}
-
-ECheckBoxState SMinesweeper::GetPlayerHintState() const
-{
-	return PlayerHintState;
-}
-
-void SMinesweeper::OnPlayerHintChanged(ECheckBoxState NewState)
-{
-	PlayerHintState = NewState;
-}
-
-FReply SMinesweeper::OnGenerateGridClicked()
-{
-	GenerateGrid();
-	return FReply::Handled();
-}
-
-#undef LOCTEXT_NAMESPACE
+﻿#include "SMinesweeper.h"
+
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+#include "SlateOptMacros.h"
+#include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Input/SSpinBox.h"
+#include "Widgets/SInvalidationPanel.h"
+
+#include "Minesweeper.h"
+#include "MinesweeperNoGuessGenerator.h"
+#include "MinesweeperRecording.h"
+#include "MinesweeperSnapshot.h"
+#include "MinesweeperStats.h"
+#include "SMinesweeperBoardView.h"
+
+#define LOCTEXT_NAMESPACE "SMinesweeper"
+
+#define DEFAULT_WIDTH 10
+#define DEFAULT_HEIGHT 10
+#define DEFAULT_NUM_MINES 25
+#define MAX_BOARD_SIZE (1 << 24)
+// Boards up to this size on both sides keep every cell in memory, larger ones are stored in chunks
+// It's also the range of the sliders, larger sizes can still be typed in
+#define MAX_DENSE_BOARD_SIZE 1000
+#define START_WITH_PLAYER_HINT true
+#define START_WITH_RANDOM_SEED true
+#define START_WITH_INFINITE_BOARD false
+#define START_WITH_NO_GUESSING false
+#define START_WITH_PROBABILITIES false
+
+static FSlateFontInfo ExtraLargeLayoutFont = FCoreStyle::GetDefaultFontStyle("Regular", 26);
+static FSlateFontInfo LargeLayoutFont = FCoreStyle::GetDefaultFontStyle("Regular", 16);
+static FSlateFontInfo MediumLayoutFont = FCoreStyle::GetDefaultFontStyle("Regular", 14);
+
+/*
+ * A board being generated on a background thread, along with everything it was asked for.
+ * The task holds its own reference, so it can safely run to the end after being cancelled or after the widget is gone.
+ * Once published it holds the previous game's board, and is reused for the next game so the cells aren't allocated again.
+ */
+struct FMinesweeperPendingBoard
+{
+	FMinesweeperPendingBoard()
+		: Width(0)
+		, Height(0)
+		, MinesCount(0)
+		, Seed(0)
+		, bNoGuessing(false)
+		, StartingPoint(INDEX_NONE)
+		, bCancel(false)
+		, bFinished(false)
+	{}
+
+	/* Get ready to generate a new board. Only called before the task is started */
+	void Initialize(int32 InWidth, int32 InHeight, int32 InMinesCount, uint64 InSeed, bool bInNoGuessing)
+	{
+		Width = InWidth;
+		Height = InHeight;
+		MinesCount = InMinesCount;
+		Seed = InSeed;
+		bNoGuessing = bInNoGuessing;
+		StartingPoint = INDEX_NONE;
+		bCancel = false;
+		bFinished = false;
+	}
+
+	/* Runs on the background thread. Nothing else touches the board until bFinished is set */
+	void Generate()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FMinesweeperPendingBoard::Generate);
+
+		// Search for a board that can be solved from its hint. If no board could be found we fall back to the board
+		// from the seed we were given
+		if (bNoGuessing)
+		{
+			const TOptional<uint64> NoGuessingSeed = FMinesweeperNoGuessGenerator::FindSeed(Width, Height, MinesCount, Seed, FMinesweeperNoGuessGenerator::DefaultMaxAttempts, &bCancel);
+			if (NoGuessingSeed.IsSet())
+			{
+				Seed = NoGuessingSeed.GetValue();
+			}
+		}
+
+		if (!bCancel.Load())
+		{
+			StartingPoint = Board.GenerateMinesData(Width, Height, MinesCount, Seed);
+		}
+
+		bFinished = true;
+	}
+
+	FMinesweeperBoard Board;
+	int32 Width;
+	int32 Height;
+	int32 MinesCount;
+	uint64 Seed;
+	bool bNoGuessing;
+	int32 StartingPoint;
+
+	TAtomic<bool> bCancel;
+	TAtomic<bool> bFinished;
+};
+
+SMinesweeper::SMinesweeper()
+	: DesiredWidth(DEFAULT_WIDTH)
+	, DesiredHeight(DEFAULT_HEIGHT)
+	, DesiredMinesCount(DEFAULT_NUM_MINES)
+	, Solver(Board)
+{
+}
+
+SMinesweeper::~SMinesweeper()
+{
+	// Closing the tab stops the search for a no guessing board, rather than leaving it running for a board nobody will see
+	if (PendingBoard.IsValid())
+	{
+		PendingBoard->bCancel = true;
+	}
+}
+
+void SMinesweeper::Construct(const FArguments& InArgs)
+{
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+SVerticalBox::Slot()
+		.Padding(5)
+		.AutoHeight()
+		[
+			SNew(SHorizontalBox)
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("Minesweeper-Width", "Width"))
+				.Font(LargeLayoutFont)
+			]
+			+ SHorizontalBox::Slot().Padding(5)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SSpinBox<int>)
+				.Font(LargeLayoutFont)
+				.MinDesiredWidth(48.f)
+				.MinValue(3)
+				.MaxValue(MAX_BOARD_SIZE)
+				.MinSliderValue(TAttribute<TOptional<int>>(1))
+				.MaxSliderValue(TAttribute<TOptional<int>>(MAX_DENSE_BOARD_SIZE))
+				.Delta(1)
+				.Value(this, &SMinesweeper::GetDesiredWidth)
+				.OnValueChanged(this, &SMinesweeper::OnDesiredWidthChanged)
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("Minesweeper-Height", "Height"))
+				.Font(LargeLayoutFont)
+			]
+			+ SHorizontalBox::Slot().Padding(5)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SSpinBox<int>)
+				.Font(LargeLayoutFont)
+				.MinDesiredWidth(48.f)
+				.MinValue(3)
+				.MaxValue(MAX_BOARD_SIZE)
+				.MinSliderValue(TAttribute<TOptional<int>>(1))
+				.MaxSliderValue(TAttribute<TOptional<int>>(MAX_DENSE_BOARD_SIZE))
+				.Delta(1)
+				.Value(this, &SMinesweeper::GetDesiredHeight)
+				.OnValueChanged(this, &SMinesweeper::OnDesiredHeightChanged)
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("Minesweeper-NumMines", "Number of Mines"))
+				.Font(LargeLayoutFont)
+			]
+			+ SHorizontalBox::Slot().Padding(5)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SSpinBox<int64>)
+				.Font(LargeLayoutFont)
+				.MinDesiredWidth(64.f)
+				.MinValue(3)
+				.MinSliderValue(TAttribute<TOptional<int64>>(1))
+				.Delta(1)
+				.Value(this, &SMinesweeper::GetDesiredMinesNum)
+				.OnValueChanged(this, &SMinesweeper::OnDesiredMinesNumChanged)
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("Minesweeper-Seed", "Seed"))
+				.Font(LargeLayoutFont)
+			]
+			+ SHorizontalBox::Slot().Padding(5)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SAssignNew(SeedTextBox, SEditableTextBox)
+				.Font(LargeLayoutFont)
+				.MinDesiredWidth(200.f)
+				.OnTextCommitted(this, &SMinesweeper::OnDesiredSeedCommitted)
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SVerticalBox)
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SNew(SCheckBox)
+					.IsChecked(this, &SMinesweeper::GetPlayerHintState)
+					.OnCheckStateChanged(this, &SMinesweeper::OnPlayerHintChanged)
+					[
+						SNew(STextBlock).Text(LOCTEXT("Minesweeper-Hint", "Start with Hint"))
+					]
+				]
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SNew(SCheckBox)
+					.IsChecked(this, &SMinesweeper::GetNoGuessingState)
+					.OnCheckStateChanged(this, &SMinesweeper::OnNoGuessingChanged)
+					.ToolTipText(LOCTEXT("Minesweeper-NoGuessingTooltip", "Only deal boards which can be solved from the hint without guessing. Boards too large to hold every cell are dealt as they come"))
+					[
+						SNew(STextBlock).Text(LOCTEXT("Minesweeper-NoGuessing", "No Guessing"))
+					]
+				]
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SAssignNew(ShowProbabilitiesCheckBox, SCheckBox)
+					.IsChecked(this, &SMinesweeper::GetShowProbabilitiesState)
+					.OnCheckStateChanged(this, &SMinesweeper::OnShowProbabilitiesChanged)
+					.ToolTipText(LOCTEXT("Minesweeper-ShowProbabilitiesTooltip", "Tint every hidden cell from green to red by the chance of it being a mine. Only available on boards which aren't chunked"))
+					[
+						SNew(STextBlock).Text(LOCTEXT("Minesweeper-ShowProbabilities", "Show Probabilities"))
+					]
+				]
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SNew(SCheckBox)
+					.IsChecked(this, &SMinesweeper::GetDebugMinesState)
+					.OnCheckStateChanged(this, &SMinesweeper::OnDebugMinesChanged)
+					[
+						SNew(STextBlock).Text(LOCTEXT("Minesweeper-DebugMines", "(Cheat) Show Mines"))
+					]
+				]
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SNew(SCheckBox)
+					.IsChecked(this, &SMinesweeper::GetInfiniteBoardState)
+					.OnCheckStateChanged(this, &SMinesweeper::OnInfiniteBoardChanged)
+					.ToolTipText(FText::Format(LOCTEXT("Minesweeper-InfiniteBoardTooltip", "A board without edges, with the same density of mines as the width, height and number of mines above, but never less than {0}"),
+						FText::AsPercent(FMinesweeperChunkedBoard::MinInfiniteMineDensity)))
+					[
+						SNew(STextBlock).Text(LOCTEXT("Minesweeper-InfiniteBoard", "Infinite Board"))
+					]
+				]
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SAssignNew(InfiniteDensityWarningText, STextBlock)
+					.Visibility(EVisibility::Collapsed)
+					.ColorAndOpacity(FLinearColor(1.f, 0.6f, 0.f))
+					.Text(FText::Format(LOCTEXT("Minesweeper-InfiniteDensityWarning", "Too few mines for an infinite board, it will have {0}"),
+						FText::AsPercent(FMinesweeperChunkedBoard::MinInfiniteMineDensity)))
+				]
+				+ SVerticalBox::Slot().Padding(5, 0)
+				.AutoHeight() [
+					SNew(SCheckBox)
+					.IsChecked(this, &SMinesweeper::GetRandomSeedState)
+					.OnCheckStateChanged(this, &SMinesweeper::OnRandomSeedChanged)
+					[
+						SNew(STextBlock).Text(LOCTEXT("Minesweeper-RandomSeed", "Random Seed"))
+					]
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SButton)
+				.OnClicked(this, &SMinesweeper::OnGenerateGridClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-NewGame", "New Game"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SAssignNew(HintButton, SButton)
+				.ToolTipText(LOCTEXT("Minesweeper-SafeCellHintTooltip", "Reveal a cell which can be worked out to be safe, if there is one"))
+				.OnClicked(this, &SMinesweeper::OnHintClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-SafeCellHint", "Hint"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SAssignNew(UndoButton, SButton)
+				.ToolTipText(LOCTEXT("Minesweeper-UndoTooltip", "Take back the last reveal or flag, even the one that hit a mine"))
+				.OnClicked(this, &SMinesweeper::OnUndoClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-Undo", "Undo"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SAssignNew(RedoButton, SButton)
+				.ToolTipText(LOCTEXT("Minesweeper-RedoTooltip", "Make the last move that was undone again"))
+				.OnClicked(this, &SMinesweeper::OnRedoClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-Redo", "Redo"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SAssignNew(SaveButton, SButton)
+				.ToolTipText(LOCTEXT("Minesweeper-SaveTooltip", "Save the board as it is now, to be carried on with later"))
+				.OnClicked(this, &SMinesweeper::OnSaveClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-Save", "Save"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SButton)
+				.ToolTipText(LOCTEXT("Minesweeper-LoadTooltip", "Carry on with the last saved board"))
+				.OnClicked(this, &SMinesweeper::OnLoadClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-Load", "Load"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SNew(SButton)
+				.ToolTipText(LOCTEXT("Minesweeper-ReplayTooltip", "Play back the last recorded game as it was played, from the board it was dealt"))
+				.OnClicked(this, &SMinesweeper::OnReplayClicked)
+				[
+					SNew(STextBlock)
+					.Font(MediumLayoutFont)
+					.Text(LOCTEXT("Minesweeper-Replay", "Replay"))
+				]
+			]
+			+ SHorizontalBox::Slot().Padding(10)
+			.VAlign(VAlign_Center)
+			.AutoWidth()
+			[
+				SAssignNew(CountersText, STextBlock)
+				.Font(MediumLayoutFont)
+			]
+		]
+		+ SVerticalBox::Slot()
+		.FillHeight(1)
+		[
+			// Nothing in here is polled, everything is invalidated when the board tells us it changed,
+			// so the grid can be cached and an idle board costs next to nothing to draw
+			SNew(SInvalidationPanel)
+			[
+				SNew(SOverlay)
+				+ SOverlay::Slot() [
+					SAssignNew(BoardView, SMinesweeperBoardView)
+						.MinCellSize(24.f)
+						.Font(MediumLayoutFont)
+						.OnCellClicked(this, &SMinesweeper::OnCellClicked)
+						.OnCellRightClicked(this, &SMinesweeper::OnCellRightClicked)
+				]
+				+ SOverlay::Slot()
+				.HAlign(HAlign_Center)
+				.VAlign(VAlign_Center)
+				[
+					SAssignNew(GameOverText, STextBlock)
+					.Visibility(EVisibility::Hidden)
+					.Font(ExtraLargeLayoutFont)
+					.Text(LOCTEXT("Minesweeper-GameOver", "Game Over!"))
+				]
+				+ SOverlay::Slot()
+				.HAlign(HAlign_Center)
+				.VAlign(VAlign_Center)
+				[
+					SAssignNew(GeneratingText, STextBlock)
+					.Visibility(EVisibility::Hidden)
+					.Font(ExtraLargeLayoutFont)
+					.Text(LOCTEXT("Minesweeper-Generating", "Generating..."))
+				]
+			]
+		]
+	];
+
+	// The view draws whichever board we're playing, and we only need to hear about the game ending
+	// and, for the probability overlay and the counters, about cells being revealed and flagged
+	Board.OnBoardChanged().AddSP(this, &SMinesweeper::HandleBoardChanged);
+	Board.OnCellsChanged().AddSP(this, &SMinesweeper::HandleCellsChanged);
+	ChunkedBoard.OnBoardChanged().AddSP(this, &SMinesweeper::HandleBoardChanged);
+	ChunkedBoard.OnCellsChanged().AddSP(this, &SMinesweeper::HandleChunkedCellsChanged);
+
+	OnDebugMinesChanged(ECheckBoxState::Unchecked);
+
+	// We can start with a player hint by setting this to true
+	// Which will "activate" a non-mine cell randomly on the board (including cascade)
+	OnPlayerHintChanged(START_WITH_PLAYER_HINT ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
+	OnNoGuessingChanged(START_WITH_NO_GUESSING ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
+
+	// With random seeds every new game rolls a new seed, otherwise the seed entered in the toolbar is used
+	// Either way the seed of the current board is shown in the toolbar so it can be reproduced
+	OnRandomSeedChanged(START_WITH_RANDOM_SEED ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
+	OnInfiniteBoardChanged(START_WITH_INFINITE_BOARD ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
+	DesiredSeed = 0;
+	UpdateSeedText();
+	bUseChunkedBoard = false;
+
+	// Every game is appended to the same log, which is kept open so recording an input is a single write
+	NextReplayInput = 0;
+	ReplayStartSeconds = 0.0;
+	bIsReplaying = false;
+	if (!Recorder.Open(*FMinesweeperRecorder::GetDefaultFilename()))
+	{
+		UE_LOG(LogMinesweeper, Warning, TEXT("Couldn't open %s, games won't be recorded"), *FMinesweeperRecorder::GetDefaultFilename());
+	}
+
+	// The overlay is worked out from the board, so this has to wait until we know which board we're playing on
+	OnShowProbabilitiesChanged(START_WITH_PROBABILITIES ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
+	
+	// Let's set some default values
+	OnDesiredWidthChanged(DEFAULT_WIDTH);
+	OnDesiredHeightChanged(DEFAULT_HEIGHT);
+	OnDesiredMinesNumChanged(DEFAULT_NUM_MINES);
+	GenerateGrid(GetSeedForNewGame());
+}
+
+void SMinesweeper::GenerateGrid(uint64 Seed)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperGenerateGrid);
+
+	// Asking for a new game again, before the last one is ready, replaces it
+	CancelGeneration();
+
+	// The game being recorded or replayed is over either way, the new one is recorded from when it's published
+	StopReplay();
+	Recorder.EndGame();
+
+	// Generate our cell data, as well as mine placement
+	// The board view draws every cell itself and is told when the board changes, so there's nothing to build per cell
+	// We'll give the player a random starting point hint if it's enabled and we actually have one
+	// The scenarios in which we don't have one would be if the grid is entirely filled with mines, which
+	// can happen depending on some tweaks to the control widgets
+	// Boards too large to hold every cell are played on the chunked board, which only keeps the cells that have been played
+	// Infinite boards are always chunked, as they're generated as they're looked at
+	if (IsInfiniteBoardEnabled() || DesiredWidth > MAX_DENSE_BOARD_SIZE || DesiredHeight > MAX_DENSE_BOARD_SIZE)
+	{
+		// Chunked boards don't generate anything up front, so there's nothing to gain from doing this in the background
+		bUseChunkedBoard = true;
+		BoardView->SetBoard(&ChunkedBoard);
+
+		// An infinite board uses the density of the board described by the toolbar, raised if it's too sparse to play
+		const FIntPoint StartingPoint = IsInfiniteBoardEnabled()
+			? ChunkedBoard.GenerateInfiniteMinesData(GetDesiredMineDensity(), Seed)
+			: ChunkedBoard.GenerateMinesData(DesiredWidth, DesiredHeight, DesiredMinesCount, Seed);
+
+		if (StartingPoint != FIntPoint::NoneValue)
+		{
+			if (IsPlayerHintEnabled())
+			{
+				ChunkedBoard.ActivateCell(StartingPoint);
+			}
+
+			// These boards are far larger than the view, so we start where the hint is rather than in a corner
+			BoardView->CenterOnCell(StartingPoint);
+		}
+	}
+	else
+	{
+		// Placing mines takes time in proportion to the size of the board, and searching for a no guessing board can take
+		// far longer, so both happen on a background thread. The current board stays up until the new one is published
+		// The board the last game swapped out is generated into, which reuses its allocations when the size doesn't grow.
+		// A board that was cancelled may still be in use by its task, so that one is never reused
+		PendingBoard = MoveTemp(SpareBoard);
+		if (!PendingBoard.IsValid())
+		{
+			PendingBoard = MakeShared<FMinesweeperPendingBoard, ESPMode::ThreadSafe>();
+		}
+		PendingBoard->Initialize(DesiredWidth, DesiredHeight, static_cast<int32>(DesiredMinesCount), Seed, IsNoGuessingEnabled());
+
+		AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Pending = PendingBoard]()
+		{
+			Pending->Generate();
+		});
+
+		if (!GenerationTimer.IsValid())
+		{
+			GenerationTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeper::UpdateGeneration));
+		}
+
+		// The last game is over either way, and its result is cleared once the new board is published
+		GameOverText->SetVisibility(EVisibility::Hidden);
+		GeneratingText->SetVisibility(EVisibility::HitTestInvisible);
+	}
+
+	// Nothing can be played or undone while the board generates, and the chunked board may have taken over
+	UpdateToolbar();
+}
+
+bool SMinesweeper::IsGenerating() const
+{
+	return PendingBoard.IsValid();
+}
+
+void SMinesweeper::CancelGeneration()
+{
+	if (PendingBoard.IsValid())
+	{
+		PendingBoard->bCancel = true;
+		PendingBoard.Reset();
+	}
+
+	if (GeneratingText.IsValid())
+	{
+		GeneratingText->SetVisibility(EVisibility::Hidden);
+	}
+}
+
+EActiveTimerReturnType SMinesweeper::UpdateGeneration(double InCurrentTime, float InDeltaTime)
+{
+	if (!PendingBoard.IsValid())
+	{
+		return EActiveTimerReturnType::Stop;
+	}
+
+	if (!PendingBoard->bFinished.Load())
+	{
+		return EActiveTimerReturnType::Continue;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMinesweeper::PublishBoard);
+
+	// The task is done with the board, so nothing else can be looking at it
+	const TSharedPtr<FMinesweeperPendingBoard, ESPMode::ThreadSafe> Pending = MoveTemp(PendingBoard);
+	SpareBoard = Pending;
+	GeneratingText->SetVisibility(EVisibility::Hidden);
+
+	// The board is published in one swap, which everything observing it hears about as a single new game
+	bUseChunkedBoard = false;
+	BoardView->SetBoard(&Board);
+	Board.SwapBoard(Pending->Board);
+
+	// Show the seed of the board we ended up with, so it can be dealt again.
+	// Generating from a seed that's already solvable gives the same seed back, so this works with or without the option.
+	DesiredSeed = Pending->Seed;
+	UpdateSeedText();
+
+	// A replay deals the board from the same seed, and the hint is recorded along with the player's inputs
+	Recorder.BeginGame(Board.GetWidth(), Board.GetHeight(), Board.GetMinesCount(), Board.GetSeed());
+
+	// The board is only guaranteed to be solvable from its hint, so the hint is always given without guessing
+	if ((IsPlayerHintEnabled() || Pending->bNoGuessing) && Pending->StartingPoint > -1)
+	{
+		Recorder.RecordInput(EMinesweeperInputType::Reveal, Pending->StartingPoint);
+		Board.ActivateCell(Pending->StartingPoint);
+	}
+
+	return EActiveTimerReturnType::Stop;
+}
+
+bool SMinesweeper::CanPlay() const
+{
+	return !IsGenerating() && (bUseChunkedBoard ? ChunkedBoard.CanPlay() : Board.CanPlay());
+}
+
+void SMinesweeper::HandleBoardChanged()
+{
+	const bool bWon = bUseChunkedBoard ? ChunkedBoard.HasWon() : Board.HasWon();
+	GameOverText->SetText(bWon ? LOCTEXT("Minesweeper-YouWin", "You Win!") : LOCTEXT("Minesweeper-GameOver", "Game Over!"));
+	GameOverText->SetVisibility(CanPlay() ? EVisibility::Hidden : EVisibility::Visible);
+	UpdateProbabilities();
+	UpdateToolbar();
+}
+
+void SMinesweeper::HandleCellsChanged(TArrayView<const int32> ChangedCells)
+{
+	UpdateProbabilities();
+	UpdateToolbar();
+}
+
+void SMinesweeper::HandleChunkedCellsChanged(TArrayView<const FIntPoint> ChangedCells)
+{
+	UpdateToolbar();
+}
+
+void SMinesweeper::UpdateToolbar()
+{
+	// An infinite board has no number of mines, so there's nothing to count down from and no total of safe cells
+	if (bUseChunkedBoard && ChunkedBoard.IsInfinite())
+	{
+		CountersText->SetText(FText::Format(LOCTEXT("Minesweeper-InfiniteCounters", "Revealed: {0}   Flags: {1}"),
+			FText::AsNumber(ChunkedBoard.GetNumRevealedSafeCells()),
+			FText::AsNumber(ChunkedBoard.GetNumFlags())));
+	}
+	else
+	{
+		CountersText->SetText(FText::Format(LOCTEXT("Minesweeper-Counters", "Mines Left: {0}   Revealed: {1} / {2}   Flags: {3}"),
+			FText::AsNumber(bUseChunkedBoard ? ChunkedBoard.GetNumMinesRemaining() : Board.GetNumMinesRemaining()),
+			FText::AsNumber(bUseChunkedBoard ? ChunkedBoard.GetNumRevealedSafeCells() : Board.GetNumRevealedSafeCells()),
+			FText::AsNumber(bUseChunkedBoard ? ChunkedBoard.GetNumSafeCells() : Board.GetNumSafeCells()),
+			FText::AsNumber(bUseChunkedBoard ? ChunkedBoard.GetNumFlags() : Board.GetNumFlags())));
+	}
+
+	// The hint, undo and probabilities all need every cell, so they're only available on the dense board
+	const bool bCanChangeBoard = !IsGenerating() && !IsReplaying() && !bUseChunkedBoard;
+	HintButton->SetEnabled(bCanChangeBoard && CanPlay());
+	UndoButton->SetEnabled(bCanChangeBoard && Board.CanUndo());
+	RedoButton->SetEnabled(bCanChangeBoard && Board.CanRedo());
+	SaveButton->SetEnabled(!IsGenerating());
+	ShowProbabilitiesCheckBox->SetEnabled(!bUseChunkedBoard);
+}
+
+void SMinesweeper::UpdateProbabilities()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMinesweeper::UpdateProbabilities);
+
+	// There's nothing left to work out once the game is over, and chunked boards are far too large to work out at all
+	if (!IsShowProbabilitiesEnabled() || bUseChunkedBoard || !Board.CanPlay())
+	{
+		BoardView->SetMineProbabilities(TArrayView<const float>());
+		return;
+	}
+
+	// The solver takes care of everything that can be deduced, so only what's left is enumerated, and only the parts
+	// of the frontier this move changed
+	Solver.Solve();
+	Probability.Compute(Board, Solver);
+	BoardView->SetMineProbabilities(Probability.GetMineProbabilities());
+}
+
+void SMinesweeper::OnCellClicked(const FIntPoint& Cell)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMinesweeper::OnCellClicked);
+
+	if (!CanPlay() || IsReplaying())
+	{
+		return;
+	}
+
+	if (bUseChunkedBoard)
+	{
+		ChunkedBoard.ActivateCell(Cell);
+	}
+	else
+	{
+		// Clicking a number that's already revealed chords it, revealing the rest of its neighbours once they're flagged
+		const int32 Idx = Board.GetIndex(Cell.Y, Cell.X);
+		const bool bChord = Board.GetCell(Idx).WasActivated();
+		const FMinesweeperMove Move(bChord ? EMinesweeperMoveType::Chord : EMinesweeperMoveType::Reveal, Idx);
+
+		Recorder.RecordInput(bChord ? EMinesweeperInputType::Chord : EMinesweeperInputType::Reveal, Idx);
+		Board.ApplyMoves(MakeArrayView(&Move, 1));
+	}
+}
+
+void SMinesweeper::OnCellRightClicked(const FIntPoint& Cell)
+{
+	// Activated cells are disabled, so they can't be flagged
+	if (!CanPlay() || IsReplaying())
+	{
+		return;
+	}
+
+	if (bUseChunkedBoard)
+	{
+		if (!ChunkedBoard.GetCell(Cell).WasActivated())
+		{
+			ChunkedBoard.ToggleFlag(Cell);
+		}
+	}
+	else
+	{
+		const int32 Idx = Board.GetIndex(Cell.Y, Cell.X);
+		if (!Board.GetCell(Idx).WasActivated())
+		{
+			Recorder.RecordInput(EMinesweeperInputType::Flag, Idx);
+			Board.ToggleFlag(Idx);
+		}
+	}
+}
+
+int32 SMinesweeper::GetDesiredWidth() const
+{
+	return DesiredWidth;
+}
+
+void SMinesweeper::OnDesiredWidthChanged(int32 NewVal)
+{
+	DesiredWidth = NewVal;
+
+	// We need to make sure to update Mines as well, if we're changing this value
+	// We'll just pass in the existing value. It could still be valid.
+	OnDesiredMinesNumChanged(DesiredMinesCount);
+}
+
+int32 SMinesweeper::GetDesiredHeight() const
+{
+	return DesiredHeight;
+}
+
+void SMinesweeper::OnDesiredHeightChanged(int32 NewVal)
+{
+	DesiredHeight = NewVal;
+
+	// We need to make sure to update Mines as well, if we're changing this value
+	// We'll just pass in the existing value. It could still be valid.
+	OnDesiredMinesNumChanged(DesiredMinesCount);
+}
+
+int64 SMinesweeper::GetDesiredMinesNum() const
+{
+	return DesiredMinesCount;
+}
+
+void SMinesweeper::OnDesiredMinesNumChanged(int64 NewVal)
+{
+	// Yes, you CAN fill the entire grid with mines.
+	// No, it will not be a fun game.
+	// Chunked boards can hold more cells than an int32 can count, so this is worked out in 64 bits
+	DesiredMinesCount = FMath::Clamp<int64>(NewVal, 1, (int64(GetDesiredWidth()) * GetDesiredHeight()) - 3);
+	UpdateInfiniteDensityWarning();
+}
+
+bool SMinesweeper::IsDebugMinesEnabled() const
+{
+	return DebugMinesState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState SMinesweeper::GetDebugMinesState() const
+{
+	return DebugMinesState;
+}
+
+void SMinesweeper::OnDebugMinesChanged(ECheckBoxState NewState)
+{
+	DebugMinesState = NewState;
+	BoardView->SetShowMines(IsDebugMinesEnabled());
+}
+
+bool SMinesweeper::IsPlayerHintEnabled() const
+{
+	return PlayerHintState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState SMinesweeper::GetPlayerHintState() const
+{
+	return PlayerHintState;
+}
+
+void SMinesweeper::OnPlayerHintChanged(ECheckBoxState NewState)
+{
+	PlayerHintState = NewState;
+}
+
+bool SMinesweeper::IsNoGuessingEnabled() const
+{
+	return NoGuessingState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState SMinesweeper::GetNoGuessingState() const
+{
+	return NoGuessingState;
+}
+
+void SMinesweeper::OnNoGuessingChanged(ECheckBoxState NewState)
+{
+	NoGuessingState = NewState;
+}
+
+bool SMinesweeper::IsInfiniteBoardEnabled() const
+{
+	return InfiniteBoardState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState SMinesweeper::GetInfiniteBoardState() const
+{
+	return InfiniteBoardState;
+}
+
+void SMinesweeper::OnInfiniteBoardChanged(ECheckBoxState NewState)
+{
+	InfiniteBoardState = NewState;
+	UpdateInfiniteDensityWarning();
+}
+
+double SMinesweeper::GetDesiredMineDensity() const
+{
+	return double(DesiredMinesCount) / (double(DesiredWidth) * DesiredHeight);
+}
+
+void SMinesweeper::UpdateInfiniteDensityWarning()
+{
+	// The toolbar's values are set up after the widgets, so this is called once more when they are
+	if (InfiniteDensityWarningText.IsValid())
+	{
+		const bool bTooSparse = IsInfiniteBoardEnabled() && GetDesiredMineDensity() < FMinesweeperChunkedBoard::MinInfiniteMineDensity;
+		InfiniteDensityWarningText->SetVisibility(bTooSparse ? EVisibility::Visible : EVisibility::Collapsed);
+	}
+}
+
+bool SMinesweeper::IsShowProbabilitiesEnabled() const
+{
+	return ShowProbabilitiesState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState SMinesweeper::GetShowProbabilitiesState() const
+{
+	return ShowProbabilitiesState;
+}
+
+void SMinesweeper::OnShowProbabilitiesChanged(ECheckBoxState NewState)
+{
+	ShowProbabilitiesState = NewState;
+	UpdateProbabilities();
+}
+
+bool SMinesweeper::IsRandomSeedEnabled() const
+{
+	return RandomSeedState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState SMinesweeper::GetRandomSeedState() const
+{
+	return RandomSeedState;
+}
+
+void SMinesweeper::OnRandomSeedChanged(ECheckBoxState NewState)
+{
+	RandomSeedState = NewState;
+	SeedTextBox->SetEnabled(!IsRandomSeedEnabled());
+}
+
+void SMinesweeper::UpdateSeedText()
+{
+	SeedTextBox->SetText(FText::FromString(FString::Printf(TEXT("%llu"), DesiredSeed)));
+}
+
+void SMinesweeper::OnDesiredSeedCommitted(const FText& NewText, ETextCommit::Type CommitType)
+{
+	// Only plain digits that fit in a seed are taken. Anything else, signs, decimal points and overflowing numbers included,
+	// is ignored and we keep the previous seed
+	const FString SeedString = NewText.ToString().TrimStartAndEnd();
+	bool bValidSeed = !SeedString.IsEmpty();
+	uint64 Seed = 0;
+
+	for (int32 Index = 0; bValidSeed && Index < SeedString.Len(); Index++)
+	{
+		const TCHAR Char = SeedString[Index];
+		const uint64 Digit = Char - TEXT('0');
+
+		bValidSeed = FChar::IsDigit(Char) && Seed <= (TNumericLimits<uint64>::Max() - Digit) / 10;
+		Seed = Seed * 10 + Digit;
+	}
+
+	if (bValidSeed)
+	{
+		DesiredSeed = Seed;
+	}
+
+	// Puts the previous seed back if this one was ignored
+	UpdateSeedText();
+}
+
+uint64 SMinesweeper::GetSeedForNewGame()
+{
+	if (IsRandomSeedEnabled())
+	{
+		DesiredSeed = FMinesweeperRandomStream::MakeSeed();
+		UpdateSeedText();
+	}
+
+	return DesiredSeed;
+}
+
+FReply SMinesweeper::OnGenerateGridClicked()
+{
+	GenerateGrid(GetSeedForNewGame());
+	return FReply::Handled();
+}
+
+FReply SMinesweeper::OnHintClicked()
+{
+	// The solver follows the board by itself, so this only looks at what changed since the last hint
+	if (CanPlay() && !bUseChunkedBoard && !IsReplaying())
+	{
+		Solver.Solve();
+
+		if (Solver.GetSafeCells().Num() > 0)
+		{
+			// A replay doesn't run the solver, so the hint is recorded as the cell it revealed
+			const int32 SafeCell = Solver.GetSafeCells()[0];
+			Recorder.RecordInput(EMinesweeperInputType::Reveal, SafeCell);
+			Board.ActivateCell(SafeCell);
+		}
+	}
+
+	return FReply::Handled();
+}
+
+FReply SMinesweeper::OnUndoClicked()
+{
+	// The view, the solver and the game over text all follow the board's events, so there's nothing else to do
+	if (!IsGenerating() && !IsReplaying() && !bUseChunkedBoard && Board.Undo())
+	{
+		Recorder.RecordInput(EMinesweeperInputType::Undo);
+	}
+
+	return FReply::Handled();
+}
+
+FReply SMinesweeper::OnRedoClicked()
+{
+	if (!IsGenerating() && !IsReplaying() && !bUseChunkedBoard && Board.Redo())
+	{
+		Recorder.RecordInput(EMinesweeperInputType::Redo);
+	}
+
+	return FReply::Handled();
+}
+
+FString SMinesweeper::GetSnapshotFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Minesweeper") / TEXT("Board.snapshot");
+}
+
+FReply SMinesweeper::OnSaveClicked()
+{
+	if (!IsGenerating())
+	{
+		const FString Filename = GetSnapshotFilename();
+		const bool bSaved = bUseChunkedBoard
+			? FMinesweeperSnapshot::SaveToFile(ChunkedBoard, *Filename)
+			: FMinesweeperSnapshot::SaveToFile(Board, *Filename);
+
+		UE_CLOG(!bSaved, LogMinesweeper, Warning, TEXT("Couldn't save the board to %s"), *Filename);
+	}
+
+	return FReply::Handled();
+}
+
+FReply SMinesweeper::OnLoadClicked()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMinesweeper::LoadSnapshot);
+
+	const FString Filename = GetSnapshotFilename();
+	const bool bLoaded = FMinesweeperSnapshot::ReadFile(*Filename, [this](TArrayView<const uint8> Data)
+	{
+		// A refused snapshot leaves the board alone, so nothing changes until it's been loaded
+		const bool bChunked = FMinesweeperSnapshot::IsChunkedSnapshot(Data);
+		if (bChunked ? !FMinesweeperSnapshot::Load(Data, ChunkedBoard) : !FMinesweeperSnapshot::Load(Data, Board))
+		{
+			return false;
+		}
+
+		// Whatever was generating would replace the board we just loaded, and a snapshot can't be dealt again from
+		// its seed, so it isn't recorded
+		CancelGeneration();
+		StopReplay();
+		Recorder.EndGame();
+		bUseChunkedBoard = bChunked;
+		if (bChunked)
+		{
+			BoardView->SetBoard(&ChunkedBoard);
+		}
+		else
+		{
+			BoardView->SetBoard(&Board);
+		}
+
+		// The toolbar describes the loaded board, so a new game deals the same one again
+		if (bChunked)
+		{
+			OnInfiniteBoardChanged(ChunkedBoard.IsInfinite() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked);
+			if (!ChunkedBoard.IsInfinite())
+			{
+				DesiredWidth = ChunkedBoard.GetWidth();
+				DesiredHeight = ChunkedBoard.GetHeight();
+				DesiredMinesCount = ChunkedBoard.GetMinesCount();
+			}
+			DesiredSeed = ChunkedBoard.GetSeed();
+		}
+		else
+		{
+			OnInfiniteBoardChanged(ECheckBoxState::Unchecked);
+			DesiredWidth = Board.GetWidth();
+			DesiredHeight = Board.GetHeight();
+			DesiredMinesCount = Board.GetMinesCount();
+			DesiredSeed = Board.GetSeed();
+		}
+		UpdateSeedText();
+
+		// The board broadcast before we switched to it, so bring the game over text, probabilities and toolbar up to date
+		HandleBoardChanged();
+		return true;
+	});
+
+	UE_CLOG(!bLoaded, LogMinesweeper, Warning, TEXT("Couldn't load a board from %s"), *Filename);
+
+	return FReply::Handled();
+}
+
+FReply SMinesweeper::OnReplayClicked()
+{
+	TArray<FMinesweeperRecordedGame> Games;
+	if (!FMinesweeperReplay::LoadFromFile(*FMinesweeperRecorder::GetDefaultFilename(), Games) || Games.Num() == 0)
+	{
+		UE_LOG(LogMinesweeper, Warning, TEXT("There's no recorded game to replay in %s"), *FMinesweeperRecorder::GetDefaultFilename());
+		return FReply::Handled();
+	}
+
+	// The last game is usually the one being played, which is replayed up to where it's got to.
+	// Replays aren't recorded themselves, as they'd only add a copy of the game they replay
+	CancelGeneration();
+	Recorder.EndGame();
+	ReplayGame = MoveTemp(Games.Last());
+
+	// The toolbar describes the replayed board, so a new game deals the same one again
+	OnInfiniteBoardChanged(ECheckBoxState::Unchecked);
+	DesiredWidth = ReplayGame.Width;
+	DesiredHeight = ReplayGame.Height;
+	DesiredMinesCount = ReplayGame.MinesCount;
+	DesiredSeed = ReplayGame.Seed;
+
+	bUseChunkedBoard = false;
+	BoardView->SetBoard(&Board);
+	FMinesweeperReplay::DealBoard(ReplayGame, Board);
+
+	UpdateSeedText();
+
+	bIsReplaying = true;
+	NextReplayInput = 0;
+	ReplayStartSeconds = FPlatformTime::Seconds();
+
+	// Dealing the board updated the toolbar before we started replaying, which is when the buttons have to be turned off
+	UpdateToolbar();
+
+	if (!ReplayTimer.IsValid())
+	{
+		ReplayTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeper::UpdateReplay));
+	}
+
+	return FReply::Handled();
+}
+
+bool SMinesweeper::IsReplaying() const
+{
+	return bIsReplaying;
+}
+
+void SMinesweeper::StopReplay()
+{
+	// The timer stops itself the next time it ticks
+	bIsReplaying = false;
+	ReplayGame.Inputs.Reset();
+	NextReplayInput = 0;
+}
+
+EActiveTimerReturnType SMinesweeper::UpdateReplay(double InCurrentTime, float InDeltaTime)
+{
+	if (!bIsReplaying)
+	{
+		return EActiveTimerReturnType::Stop;
+	}
+
+	// Every input whose time has come is played in one go, so a fast player's inputs never fall behind the frame rate
+	const double Seconds = FPlatformTime::Seconds() - ReplayStartSeconds;
+
+	int32 EndInput = NextReplayInput;
+	while (EndInput < ReplayGame.Inputs.Num() && ReplayGame.Inputs[EndInput].Seconds <= Seconds)
+	{
+		EndInput++;
+	}
+
+	FMinesweeperReplay::ApplyInputs(MakeArrayView(ReplayGame.Inputs.GetData() + NextReplayInput, EndInput - NextReplayInput), Board);
+	NextReplayInput = EndInput;
+
+	if (NextReplayInput == ReplayGame.Inputs.Num())
+	{
+		StopReplay();
+		UpdateToolbar();
+		return EActiveTimerReturnType::Stop;
+	}
+
+	return EActiveTimerReturnType::Continue;
+}
+
+#undef LOCTEXT_NAMESPACE
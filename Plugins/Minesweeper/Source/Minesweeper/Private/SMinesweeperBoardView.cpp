@@ -0,0 +1,663 @@
+﻿#include "SMinesweeperBoardView.h"
+
+#include "Fonts/FontMeasure.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Styling/CoreStyle.h"
+
+#include "MinesweeperBoard.h"
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperStats.h"
+
+// Gap left between cells, so they read as separate buttons
+#define CELL_PADDING 1.f
+
+// Number of cells a single notch of the mouse wheel scrolls
+#define WHEEL_SCROLL_CELLS 3.f
+
+// Opacity of the mine probability overlay, low enough that hovered and pressed cells still show through
+#define PROBABILITY_OVERLAY_OPACITY 0.45f
+
+// How a cell is drawn, as cached per cell in CellDisplayStates
+// Values 0-8 are an activated cell showing its nearby mines count, the rest are below
+namespace MinesweeperCellDisplay
+{
+	static constexpr uint8 Hidden = 9;
+	static constexpr uint8 Flagged = 10;
+	static constexpr uint8 Mine = 11;
+	static constexpr uint8 FlaggedMine = 12;
+	static constexpr uint8 Num = 13;
+
+	// Set on cells which can no longer be clicked, and so are drawn disabled
+	static constexpr uint8 DisabledBit = 1 << 7;
+}
+
+// Number of label texts that have ever been created, see GetNumLabelTextsCreated
+static int32 NumLabelTextsCreated = 0;
+
+// Labels for every display state, built once and shared by every view. Painting only ever references these,
+// so drawing labels doesn't create, format or allocate any text once they exist
+static const TArray<FText>& GetCellLabels()
+{
+	static const TArray<FText> CellLabels = []()
+	{
+		TArray<FText> Labels;
+		Labels.SetNum(MinesweeperCellDisplay::Num);
+
+		// A count of 0 and a hidden cell have no label
+		for (int32 NearbyMinesCount = 1; NearbyMinesCount <= 8; NearbyMinesCount++)
+		{
+			Labels[NearbyMinesCount] = FText::AsCultureInvariant(FString::FromInt(NearbyMinesCount));
+		}
+		Labels[MinesweeperCellDisplay::Flagged] = FText::AsCultureInvariant(TEXT("F"));
+		Labels[MinesweeperCellDisplay::Mine] = FText::AsCultureInvariant(TEXT("M"));
+		Labels[MinesweeperCellDisplay::FlaggedMine] = FText::AsCultureInvariant(TEXT("F-M"));
+
+		for (const FText& Label : Labels)
+		{
+			NumLabelTextsCreated += Label.IsEmpty() ? 0 : 1;
+		}
+
+		return Labels;
+	}();
+
+	return CellLabels;
+}
+
+SMinesweeperBoardView::SMinesweeperBoardView()
+	: Board(nullptr)
+	, ChunkedBoard(nullptr)
+	, ButtonStyle(nullptr)
+	, MinCellSize(24.f)
+	, bShowMines(false)
+	, PaintedCells(0, 0, 0, 0)
+	, HoveredCell(FIntPoint::NoneValue)
+	, PressedCell(FIntPoint::NoneValue)
+	, bIsPanning(false)
+	, ScrollOffsetX(0.0)
+	, ScrollOffsetY(0.0)
+	, ReportedAllocatedSize(0)
+{
+	INC_DWORD_STAT(STAT_MinesweeperBoardViews);
+}
+
+SMinesweeperBoardView::~SMinesweeperBoardView()
+{
+	DEC_DWORD_STAT(STAT_MinesweeperBoardViews);
+	DEC_MEMORY_STAT_BY(STAT_MinesweeperBoardViewMemory, ReportedAllocatedSize);
+}
+
+void SMinesweeperBoardView::Construct(const FArguments& InArgs)
+{
+	ButtonStyle = &FCoreStyle::Get().GetWidgetStyle<FButtonStyle>("Button");
+	Font = InArgs._Font;
+	MinCellSize = InArgs._MinCellSize;
+	OnCellClicked = InArgs._OnCellClicked;
+	OnCellRightClicked = InArgs._OnCellRightClicked;
+
+	// Cells along the edges are only partially visible while scrolling, so don't let them draw outside of us
+	SetClipping(EWidgetClipping::ClipToBounds);
+}
+
+void SMinesweeperBoardView::SetBoard(FMinesweeperBoard* InBoard)
+{
+	if (Board != InBoard || ChunkedBoard != nullptr)
+	{
+		ClearBoard();
+
+		Board = InBoard;
+
+		if (Board != nullptr)
+		{
+			Board->OnCellsChanged().AddSP(this, &SMinesweeperBoardView::HandleCellsChanged);
+			Board->OnBoardChanged().AddSP(this, &SMinesweeperBoardView::HandleBoardChanged);
+		}
+
+		HandleBoardChanged();
+	}
+}
+
+void SMinesweeperBoardView::SetBoard(FMinesweeperChunkedBoard* InChunkedBoard)
+{
+	if (ChunkedBoard != InChunkedBoard || Board != nullptr)
+	{
+		ClearBoard();
+
+		ChunkedBoard = InChunkedBoard;
+
+		if (ChunkedBoard != nullptr)
+		{
+			ChunkedBoard->OnCellsChanged().AddSP(this, &SMinesweeperBoardView::HandleChunkedCellsChanged);
+			ChunkedBoard->OnBoardChanged().AddSP(this, &SMinesweeperBoardView::HandleBoardChanged);
+		}
+
+		HandleBoardChanged();
+	}
+}
+
+void SMinesweeperBoardView::ClearBoard()
+{
+	if (Board != nullptr)
+	{
+		Board->OnCellsChanged().RemoveAll(this);
+		Board->OnBoardChanged().RemoveAll(this);
+		Board = nullptr;
+	}
+
+	if (ChunkedBoard != nullptr)
+	{
+		ChunkedBoard->OnCellsChanged().RemoveAll(this);
+		ChunkedBoard->OnBoardChanged().RemoveAll(this);
+		ChunkedBoard = nullptr;
+	}
+
+	MineProbabilities.Reset();
+	HoveredCell = FIntPoint::NoneValue;
+	PressedCell = FIntPoint::NoneValue;
+	ScrollOffsetX = 0.0;
+	ScrollOffsetY = 0.0;
+}
+
+void SMinesweeperBoardView::CenterOnCell(const FIntPoint& Cell)
+{
+	// We may not have been arranged yet, in which case the offset is clamped again once we're painted with our real geometry
+	const FGeometry& Geometry = GetTickSpaceGeometry();
+	const double CellSize = GetCellSize(Geometry);
+	const FVector2D LocalSize = Geometry.GetLocalSize();
+
+	SetScrollOffset(Geometry, (Cell.X + 0.5) * CellSize - LocalSize.X * 0.5, (Cell.Y + 0.5) * CellSize - LocalSize.Y * 0.5);
+	Invalidate(EInvalidateWidget::Paint);
+}
+
+void SMinesweeperBoardView::SetShowMines(bool bInShowMines)
+{
+	if (bShowMines != bInShowMines)
+	{
+		bShowMines = bInShowMines;
+		HandleBoardChanged();
+	}
+}
+
+void SMinesweeperBoardView::SetMineProbabilities(TArrayView<const float> InMineProbabilities)
+{
+	// Any cell may have changed, but only the ones on screen are drawn so there's nothing else to update
+	if (MineProbabilities.Num() > 0 || InMineProbabilities.Num() > 0)
+	{
+		MineProbabilities.Reset();
+		MineProbabilities.Append(InMineProbabilities.GetData(), InMineProbabilities.Num());
+		UpdateMemoryStats();
+		Invalidate(EInvalidateWidget::Paint);
+	}
+}
+
+void SMinesweeperBoardView::HandleCellsChanged(TArrayView<const int32> ChangedCells)
+{
+	bool bVisibleCellChanged = false;
+
+	for (const int32 CellIndex : ChangedCells)
+	{
+		const uint8 DisplayState = ComputeCellDisplayState(Board->GetCell(CellIndex), Board->CanPlay());
+		if (CellDisplayStates[CellIndex] != DisplayState)
+		{
+			CellDisplayStates[CellIndex] = DisplayState;
+			bVisibleCellChanged |= PaintedCells.Contains(FIntPoint(Board->GetCol(CellIndex), Board->GetRow(CellIndex)));
+		}
+	}
+
+	// Cells that aren't visible will be drawn from their new state once they're scrolled into view
+	if (bVisibleCellChanged)
+	{
+		Invalidate(EInvalidateWidget::Paint);
+	}
+}
+
+void SMinesweeperBoardView::HandleChunkedCellsChanged(TArrayView<const FIntPoint> ChangedCells)
+{
+	// Chunked boards are far too large to cache every cell, so their cells are looked up as they're painted
+	// and all we need to know is whether any of the changed cells are on screen
+	for (const FIntPoint& Cell : ChangedCells)
+	{
+		if (PaintedCells.Contains(Cell))
+		{
+			Invalidate(EInvalidateWidget::Paint);
+			return;
+		}
+	}
+}
+
+void SMinesweeperBoardView::HandleBoardChanged()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(SMinesweeperBoardView::HandleBoardChanged);
+
+	const int32 NumCells = Board != nullptr ? Board->Num() : 0;
+	const bool bCanPlay = Board != nullptr && Board->CanPlay();
+
+	// Reset rather than Empty, so that a new game with the same size or smaller doesn't reallocate
+	CellDisplayStates.Reset();
+	CellDisplayStates.SetNumUninitialized(NumCells);
+	for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+	{
+		CellDisplayStates[CellIndex] = ComputeCellDisplayState(Board->GetCell(CellIndex), bCanPlay);
+	}
+	UpdateMemoryStats();
+
+	// The board may have a different size, so our desired size may have changed as well as what we paint
+	Invalidate(EInvalidateWidget::Layout);
+}
+
+uint8 SMinesweeperBoardView::ComputeCellDisplayState(const FCellData& Cell, bool bCanPlay) const
+{
+	uint8 DisplayState = MinesweeperCellDisplay::Hidden;
+
+	// Reveal mines at the end of a game, or if debug mines
+	// We'll also make sure to display the Flag state if we were flagged
+	if ((!bCanPlay || bShowMines) && Cell.IsMine())
+	{
+		DisplayState = Cell.IsFlagged() ? MinesweeperCellDisplay::FlaggedMine : MinesweeperCellDisplay::Mine;
+	}
+	else if (Cell.IsFlagged())
+	{
+		DisplayState = MinesweeperCellDisplay::Flagged;
+	}
+	else if (Cell.WasActivated())
+	{
+		DisplayState = static_cast<uint8>(Cell.GetNearbyMinesCount());
+	}
+
+	// Cells behave like the buttons they replaced, so activated cells and cells on a finished board are disabled
+	if (!bCanPlay || Cell.WasActivated())
+	{
+		DisplayState |= MinesweeperCellDisplay::DisabledBit;
+	}
+
+	return DisplayState;
+}
+
+uint8 SMinesweeperBoardView::GetCellDisplayState(const FIntPoint& Cell) const
+{
+	if (ChunkedBoard != nullptr)
+	{
+		return ComputeCellDisplayState(ChunkedBoard->GetCell(Cell), ChunkedBoard->CanPlay());
+	}
+
+	return CellDisplayStates[Cell.Y * Board->GetWidth() + Cell.X];
+}
+
+bool SMinesweeperBoardView::HasBoard() const
+{
+	return GetBoardWidth() > 0 && GetBoardHeight() > 0;
+}
+
+int32 SMinesweeperBoardView::GetBoardWidth() const
+{
+	return Board != nullptr ? Board->GetWidth() : (ChunkedBoard != nullptr ? ChunkedBoard->GetWidth() : 0);
+}
+
+int32 SMinesweeperBoardView::GetBoardHeight() const
+{
+	return Board != nullptr ? Board->GetHeight() : (ChunkedBoard != nullptr ? ChunkedBoard->GetHeight() : 0);
+}
+
+void SMinesweeperBoardView::SetHoveredCell(const FIntPoint& Cell)
+{
+	if (HoveredCell != Cell)
+	{
+		HoveredCell = Cell;
+		Invalidate(EInvalidateWidget::Paint);
+	}
+}
+
+void SMinesweeperBoardView::SetPressedCell(const FIntPoint& Cell)
+{
+	if (PressedCell != Cell)
+	{
+		PressedCell = Cell;
+		Invalidate(EInvalidateWidget::Paint);
+	}
+}
+
+void SMinesweeperBoardView::UpdateMemoryStats()
+{
+#if STATS
+	const SIZE_T AllocatedSize = CellDisplayStates.GetAllocatedSize() + MineProbabilities.GetAllocatedSize();
+	if (AllocatedSize != ReportedAllocatedSize)
+	{
+		DEC_MEMORY_STAT_BY(STAT_MinesweeperBoardViewMemory, ReportedAllocatedSize);
+		INC_MEMORY_STAT_BY(STAT_MinesweeperBoardViewMemory, AllocatedSize);
+		ReportedAllocatedSize = AllocatedSize;
+	}
+#endif
+}
+
+int32 SMinesweeperBoardView::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MinesweeperPaintBoard);
+
+	if (!HasBoard())
+	{
+		return LayerId;
+	}
+
+	const float CellSize = GetCellSize(AllottedGeometry);
+	const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
+	double OffsetX, OffsetY;
+	GetScrollOffset(AllottedGeometry, OffsetX, OffsetY);
+
+	// Only the cells which are at least partially within our geometry are drawn
+	const int32 FirstCol = GetCellAtOffset(OffsetX, CellSize, GetBoardWidth());
+	const int32 LastCol = GetCellAtOffset(OffsetX + LocalSize.X, CellSize, GetBoardWidth());
+	const int32 FirstRow = GetCellAtOffset(OffsetY, CellSize, GetBoardHeight());
+	const int32 LastRow = GetCellAtOffset(OffsetY + LocalSize.Y, CellSize, GetBoardHeight());
+
+	// FIntRect's max is exclusive
+	PaintedCells = FIntRect(FirstCol, FirstRow, LastCol + 1, LastRow + 1);
+	INC_DWORD_STAT_BY(STAT_MinesweeperCellsPainted, PaintedCells.Area());
+
+	const bool bEnabled = ShouldBeEnabled(bParentEnabled);
+
+	// All of the cell boxes go on one layer, the probability overlay on the next and all of the labels on top,
+	// which lets the renderer batch each of them together rather than alternating between them
+	const int32 CellLayerId = LayerId;
+	const int32 OverlayLayerId = LayerId + 1;
+	const int32 LabelLayerId = LayerId + 2;
+
+	const FVector2D CellDrawSize(CellSize - CELL_PADDING, CellSize - CELL_PADDING);
+	const FLinearColor TintColor = InWidgetStyle.GetColorAndOpacityTint();
+	const FLinearColor LabelColor = InWidgetStyle.GetForegroundColor();
+
+	const bool bDrawProbabilities = Board != nullptr && MineProbabilities.Num() == Board->Num();
+	const FSlateBrush* OverlayBrush = FCoreStyle::Get().GetBrush("WhiteBrush");
+
+	// Labels are measured once for our font rather than for every cell we draw
+	if (CellLabelSizes.Num() != MinesweeperCellDisplay::Num)
+	{
+		const TSharedRef<FSlateFontMeasure> FontMeasure = FSlateApplication::Get().GetRenderer()->GetFontMeasureService();
+
+		CellLabelSizes.SetNumUninitialized(MinesweeperCellDisplay::Num);
+		for (uint8 DisplayState = 0; DisplayState < MinesweeperCellDisplay::Num; DisplayState++)
+		{
+			CellLabelSizes[DisplayState] = FontMeasure->Measure(GetCellLabel(DisplayState), Font);
+		}
+	}
+
+	for (int32 Row = FirstRow; Row <= LastRow; Row++)
+	{
+		for (int32 Col = FirstCol; Col <= LastCol; Col++)
+		{
+			const FIntPoint Cell(Col, Row);
+			const uint8 DisplayState = GetCellDisplayState(Cell);
+
+			const bool bCellEnabled = bEnabled && (DisplayState & MinesweeperCellDisplay::DisabledBit) == 0;
+			const ESlateDrawEffect DrawEffects = bCellEnabled ? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
+
+			const FSlateBrush* Brush = &ButtonStyle->Disabled;
+			if (bCellEnabled)
+			{
+				Brush = Cell == PressedCell ? &ButtonStyle->Pressed : (Cell == HoveredCell ? &ButtonStyle->Hovered : &ButtonStyle->Normal);
+			}
+
+			// Positions on very large boards are beyond what a float can hold to the pixel, so they're only brought
+			// into float once they're relative to our geometry
+			const FVector2D CellPosition(float(Col * double(CellSize) - OffsetX), float(Row * double(CellSize) - OffsetY));
+
+			FSlateDrawElement::MakeBox(
+				OutDrawElements,
+				CellLayerId,
+				AllottedGeometry.ToPaintGeometry(CellPosition, CellDrawSize),
+				Brush,
+				DrawEffects,
+				Brush->GetTint(InWidgetStyle) * TintColor
+			);
+
+			const uint8 LabelState = DisplayState & ~MinesweeperCellDisplay::DisabledBit;
+
+			if (bDrawProbabilities && LabelState == MinesweeperCellDisplay::Hidden)
+			{
+				const float Probability = MineProbabilities[Board->GetIndex(Row, Col)];
+
+				FSlateDrawElement::MakeBox(
+					OutDrawElements,
+					OverlayLayerId,
+					AllottedGeometry.ToPaintGeometry(CellPosition, CellDrawSize),
+					OverlayBrush,
+					DrawEffects,
+					FLinearColor(Probability, 1.f - Probability, 0.f, PROBABILITY_OVERLAY_OPACITY) * TintColor
+				);
+			}
+			const FText& Label = GetCellLabel(LabelState);
+			if (!Label.IsEmpty())
+			{
+				const FVector2D& LabelSize = CellLabelSizes[LabelState];
+
+				FSlateDrawElement::MakeText(
+					OutDrawElements,
+					LabelLayerId,
+					AllottedGeometry.ToPaintGeometry(CellPosition + (CellDrawSize - LabelSize) * 0.5f, LabelSize),
+					Label,
+					Font,
+					DrawEffects,
+					LabelColor
+				);
+			}
+		}
+	}
+
+	return LabelLayerId;
+}
+
+const FText& SMinesweeperBoardView::GetCellLabel(uint8 DisplayState)
+{
+	check(DisplayState < MinesweeperCellDisplay::Num)
+	return GetCellLabels()[DisplayState];
+}
+
+int32 SMinesweeperBoardView::GetNumLabelTextsCreated()
+{
+	return NumLabelTextsCreated;
+}
+
+FReply SMinesweeperBoardView::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const FKey Button = MouseEvent.GetEffectingButton();
+
+	if (Button == EKeys::MiddleMouseButton)
+	{
+		bIsPanning = true;
+		return FReply::Handled().CaptureMouse(SharedThis(this));
+	}
+
+	if (Button == EKeys::LeftMouseButton || Button == EKeys::RightMouseButton)
+	{
+		// Like a button, we only click once released, and only if we're released over the cell that was pressed
+		SetPressedCell(GetCellAt(MyGeometry, MouseEvent.GetScreenSpacePosition()));
+		PressedButton = Button;
+		return FReply::Handled().CaptureMouse(SharedThis(this));
+	}
+
+	return FReply::Unhandled();
+}
+
+FReply SMinesweeperBoardView::OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const FKey Button = MouseEvent.GetEffectingButton();
+
+	if (Button == EKeys::MiddleMouseButton && bIsPanning)
+	{
+		bIsPanning = false;
+		return FReply::Handled().ReleaseMouseCapture();
+	}
+
+	if (Button == PressedButton)
+	{
+		const FIntPoint Cell = GetCellAt(MyGeometry, MouseEvent.GetScreenSpacePosition());
+		const FIntPoint ClickedCell = PressedCell;
+		SetPressedCell(FIntPoint::NoneValue);
+		PressedButton = EKeys::Invalid;
+
+		if (Cell != FIntPoint::NoneValue && Cell == ClickedCell)
+		{
+			if (Button == EKeys::LeftMouseButton)
+			{
+				OnCellClicked.ExecuteIfBound(Cell);
+			}
+			else
+			{
+				OnCellRightClicked.ExecuteIfBound(Cell);
+			}
+		}
+
+		return FReply::Handled().ReleaseMouseCapture();
+	}
+
+	return FReply::Unhandled();
+}
+
+FReply SMinesweeperBoardView::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (bIsPanning)
+	{
+		const FVector2D PanDelta = MouseEvent.GetCursorDelta() / MyGeometry.Scale;
+		double OffsetX, OffsetY;
+		GetScrollOffset(MyGeometry, OffsetX, OffsetY);
+		SetScrollOffset(MyGeometry, OffsetX - PanDelta.X, OffsetY - PanDelta.Y);
+		Invalidate(EInvalidateWidget::Paint);
+		return FReply::Handled();
+	}
+
+	SetHoveredCell(GetCellAt(MyGeometry, MouseEvent.GetScreenSpacePosition()));
+	return FReply::Unhandled();
+}
+
+FReply SMinesweeperBoardView::OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	double PreviousOffsetX, PreviousOffsetY;
+	GetScrollOffset(MyGeometry, PreviousOffsetX, PreviousOffsetY);
+
+	const double ScrollAmount = MouseEvent.GetWheelDelta() * WHEEL_SCROLL_CELLS * GetCellSize(MyGeometry);
+	if (MouseEvent.IsShiftDown())
+	{
+		SetScrollOffset(MyGeometry, PreviousOffsetX - ScrollAmount, PreviousOffsetY);
+	}
+	else
+	{
+		SetScrollOffset(MyGeometry, PreviousOffsetX, PreviousOffsetY - ScrollAmount);
+	}
+
+	// Let the wheel bubble up if we couldn't scroll any further
+	if (ScrollOffsetX == PreviousOffsetX && ScrollOffsetY == PreviousOffsetY)
+	{
+		return FReply::Unhandled();
+	}
+
+	SetHoveredCell(GetCellAt(MyGeometry, MouseEvent.GetScreenSpacePosition()));
+	Invalidate(EInvalidateWidget::Paint);
+	return FReply::Handled();
+}
+
+void SMinesweeperBoardView::OnMouseLeave(const FPointerEvent& MouseEvent)
+{
+	SLeafWidget::OnMouseLeave(MouseEvent);
+
+	SetHoveredCell(FIntPoint::NoneValue);
+}
+
+void SMinesweeperBoardView::OnMouseCaptureLost(const FCaptureLostEvent& CaptureLostEvent)
+{
+	SLeafWidget::OnMouseCaptureLost(CaptureLostEvent);
+
+	SetPressedCell(FIntPoint::NoneValue);
+	PressedButton = EKeys::Invalid;
+	bIsPanning = false;
+}
+
+FVector2D SMinesweeperBoardView::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	// We'd rather fill whatever space we're given than ask for the whole board, as large boards scroll anyway
+	if (!HasBoard())
+	{
+		return FVector2D::ZeroVector;
+	}
+
+	return FVector2D(FMath::Min(GetBoardWidth(), 20) * MinCellSize, FMath::Min(GetBoardHeight(), 20) * MinCellSize);
+}
+
+float SMinesweeperBoardView::GetCellSize(const FGeometry& Geometry) const
+{
+	if (!HasBoard())
+	{
+		return MinCellSize;
+	}
+
+	const FVector2D LocalSize = Geometry.GetLocalSize();
+	const float FittedCellSize = FMath::Min(LocalSize.X / GetBoardWidth(), LocalSize.Y / GetBoardHeight());
+
+	return FMath::Max(FittedCellSize, MinCellSize);
+}
+
+void SMinesweeperBoardView::GetScrollOffset(const FGeometry& Geometry, double& OutX, double& OutY) const
+{
+	// The geometry may have changed since we last scrolled, so we clamp again whenever we use the offset
+	OutX = ScrollOffsetX;
+	OutY = ScrollOffsetY;
+	ClampScrollOffset(Geometry, OutX, OutY);
+}
+
+void SMinesweeperBoardView::SetScrollOffset(const FGeometry& Geometry, double X, double Y)
+{
+	ClampScrollOffset(Geometry, X, Y);
+	ScrollOffsetX = X;
+	ScrollOffsetY = Y;
+}
+
+void SMinesweeperBoardView::ClampScrollOffset(const FGeometry& Geometry, double& InOutX, double& InOutY) const
+{
+	if (!HasBoard())
+	{
+		InOutX = 0.0;
+		InOutY = 0.0;
+		return;
+	}
+
+	const double CellSize = GetCellSize(Geometry);
+	const FVector2D LocalSize = Geometry.GetLocalSize();
+
+	InOutX = FMath::Clamp(InOutX, 0.0, FMath::Max(GetBoardWidth() * CellSize - LocalSize.X, 0.0));
+	InOutY = FMath::Clamp(InOutY, 0.0, FMath::Max(GetBoardHeight() * CellSize - LocalSize.Y, 0.0));
+}
+
+int32 SMinesweeperBoardView::GetCellAtOffset(double Offset, float CellSize, int32 NumCells)
+{
+	return static_cast<int32>(FMath::Clamp<int64>(static_cast<int64>(FMath::FloorToDouble(Offset / CellSize)), 0, NumCells - 1));
+}
+
+FIntPoint SMinesweeperBoardView::GetCellAt(const FGeometry& Geometry, const FVector2D& ScreenSpacePosition) const
+{
+	if (!HasBoard())
+	{
+		return FIntPoint::NoneValue;
+	}
+
+	const FVector2D LocalPosition = Geometry.AbsoluteToLocal(ScreenSpacePosition);
+	const FVector2D LocalSize = Geometry.GetLocalSize();
+	if (LocalPosition.X < 0.f || LocalPosition.Y < 0.f || LocalPosition.X >= LocalSize.X || LocalPosition.Y >= LocalSize.Y)
+	{
+		return FIntPoint::NoneValue;
+	}
+
+	const float CellSize = GetCellSize(Geometry);
+	double OffsetX, OffsetY;
+	GetScrollOffset(Geometry, OffsetX, OffsetY);
+
+	const int64 Col = static_cast<int64>(FMath::FloorToDouble((OffsetX + LocalPosition.X) / CellSize));
+	const int64 Row = static_cast<int64>(FMath::FloorToDouble((OffsetY + LocalPosition.Y) / CellSize));
+
+	if (Col < 0 || Col >= GetBoardWidth() || Row < 0 || Row >= GetBoardHeight())
+	{
+		return FIntPoint::NoneValue;
+	}
+
+	return FIntPoint(static_cast<int32>(Col), static_cast<int32>(Row));
+}
+
+#undef CELL_PADDING
+#undef WHEEL_SCROLL_CELLS
+#undef PROBABILITY_OVERLAY_OPACITY
@@ -1,27 +1,41 @@
- // Copyright Epic Games, Inc. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
- class FToolBarBuilder;
-class FMenuBuilder;
-
-class FMinesweeperModule : public IModuleInterface
-{
-public:
-
-	/** IModuleInterface implementation */
-	virtual void StartupModule() override;
-	virtual void ShutdownModule() override;
-	
-	/** This function will be bound to Command (by default it will bring up plugin window) */
-	void PluginButtonClicked();
-	
-private:
-
-	void RegisterMenus();
-
-	TSharedRef<class SDockTab> OnSpawnPluginTab(const class FSpawnTabArgs& SpawnTabArgs);
-	TSharedPtr<class FUICommandList> PluginCommands;
-};
+ // Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogMinesweeper, Log, All);
+
+ class FToolBarBuilder;
+class FMenuBuilder;
+
+class FMinesweeperModule : public IModuleInterface
+{
+public:
+
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+	
+	/** This function will be bound to Command (by default it will bring up plugin window) */
+	void PluginButtonClicked();
+	
+private:
+
+	void RegisterMenus();
+
+	/* Console command which plays games headlessly and logs the results, see FMinesweeperSimulation */
+	static void Simulate(const TArray<FString>& Args);
+
+	/* Console command which runs the microbenchmarks and saves the results, see FMinesweeperBenchmark */
+	static void Benchmark(const TArray<FString>& Args);
+
+	/* Console command which replays recorded games as fast as they can be played, see FMinesweeperReplay */
+	static void Replay(const TArray<FString>& Args);
+
+	TSharedRef<class SDockTab> OnSpawnPluginTab(const class FSpawnTabArgs& SpawnTabArgs);
+	TSharedPtr<class FUICommandList> PluginCommands;
+	class IConsoleObject* SimulateCommand;
+	class IConsoleObject* BenchmarkCommand;
+	class IConsoleObject* ReplayCommand;
+};
@@ -0,0 +1,65 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+/* Timing and memory use of one benchmark on one board size */
+struct FMinesweeperBenchmarkResult
+{
+	FMinesweeperBenchmarkResult()
+		: Width(0)
+		, Height(0)
+		, MinesCount(0)
+		, NumCells(0)
+		, NumIterations(0)
+		, BestSeconds(0.0)
+		, AllocatedSizeGrowth(0)
+		, BoardAllocatedSize(0)
+	{}
+
+	FString Name;
+	int32 Width;
+	int32 Height;
+	int32 MinesCount;
+
+	/* Cells the benchmark worked on: the whole board, or the cells a reveal opened */
+	int64 NumCells;
+
+	int32 NumIterations;
+
+	/* Fastest of the iterations, as the others only add noise from the rest of the process */
+	double BestSeconds;
+
+	/* Most that the memory held by the board, or the snapshot, grew by in a single iteration */
+	int64 AllocatedSizeGrowth;
+
+	/* Memory held by the board afterwards, or by the snapshot for benchmarks which save one */
+	SIZE_T BoardAllocatedSize;
+
+	double GetNanosecondsPerCell() const;
+};
+
+/*
+ * Microbenchmarks for the engine, run on fixed seeds so every run works on exactly the same boards.
+ * Each board size is timed for generation, for counting nearby mines on its own, for the largest cascade a sparse
+ * board has, for revealing the whole board when the game ends, and for saving and loading a snapshot of it.
+ * Counting and the cascade are also timed on FMinesweeperBitboard, which has to end up exactly where the byte board does.
+ * Memory is measured with GetAllocatedSize on what each benchmark works on, before and after every iteration.
+ * Temporary allocations don't show up there, so run with -trace=memory and look at Unreal Insights to follow those.
+ */
+class MINESWEEPER_API FMinesweeperBenchmark
+{
+public:
+	/* Every board is this wide and high */
+	static const TArray<int32>& GetBoardSizes();
+
+	/* Run every benchmark on every board size, taking the best of NumIterations for each */
+	static TArray<FMinesweeperBenchmarkResult> Run(int32 NumIterations = 5);
+
+	/* Play the same random reveals and flags on FMinesweeperBitboard and FMinesweeperBoard, over boards of random sizes and
+	 * densities, and compare every cell after each one. Returns the number of boards where the two disagreed
+	 */
+	static int32 VerifyBitboard(int32 NumBoards = 500, uint64 Seed = 0);
+
+	/* Machine readable results, one row or object per benchmark and board size */
+	static FString ToCSV(const TArray<FMinesweeperBenchmarkResult>& Results);
+	static FString ToJSON(const TArray<FMinesweeperBenchmarkResult>& Results);
+};
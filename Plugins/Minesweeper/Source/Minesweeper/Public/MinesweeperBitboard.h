@@ -0,0 +1,101 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+class FMinesweeperBoard;
+
+/*
+ * Optional bitboard representation of a Minesweeper board, for bots and batch processing.
+ * The mine, flag and activated states are each stored as a plane of bits, one row at a time packed into 64-bit words,
+ * so counting and cascading operate on 64 cells per instruction rather than one.
+ *
+ * Nearby mine counts are held bit-sliced: NearbyCountPlanes[N] holds bit N of every cell's count.
+ * Bits beyond the board width in the last word of every row are always kept clear.
+ */
+class MINESWEEPER_API FMinesweeperBitboard
+{
+public:
+	FMinesweeperBitboard();
+
+	/* Clear the bitboard to an empty board of the given dimensions */
+	void Init(int32 InWidth, int32 InHeight);
+
+	/* Copy the mine placement of a generated board and compute the nearby mine counts from it
+	 * Flag and activated states are copied as well, so a game in progress can be continued on the bitboard
+	 */
+	void InitFromBoard(const FMinesweeperBoard& Board);
+
+	void SetMine(int32 Idx);
+
+	/* Compute the nearby mine counts for every cell from the mine plane, with shifted planes fed through bit-sliced adders */
+	void ComputeNearbyMinesCounts();
+
+	/* Reveal a cell, cascading outward if it has no nearby mines. Hitting a mine ends the game
+	 * Returns the number of cells this reveal opened, including the cascade
+	 */
+	int32 ActivateCell(int32 Idx);
+
+	/* Activate every cell on the board, clearing flags and ending the game */
+	void RevealAll();
+
+	/* Flip the flagged state of a cell. Revealed cells are left alone */
+	void ToggleFlag(int32 Idx);
+
+	/* Are we able to play? False once a mine has been hit */
+	bool CanPlay() const;
+
+	/* Does every cell hold the same state as the board's, nearby mines count included? */
+	bool Matches(const FMinesweeperBoard& Board) const;
+
+	bool IsMine(int32 Idx) const;
+	bool IsFlagged(int32 Idx) const;
+	bool WasActivated(int32 Idx) const;
+	int32 GetNearbyMinesCount(int32 Idx) const;
+
+	int32 GetWidth() const;
+	int32 GetHeight() const;
+
+	/* Total number of cells on the board */
+	int32 Num() const;
+
+	/* Memory held by the planes, including the cascade's scratch planes */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/* Number of bits used to hold a nearby mines count (0-8) */
+	static constexpr int32 NumCountPlanes = 4;
+
+	/* Index of the word which holds a cell, and the mask of the cell within that word */
+	int32 GetWordIndex(int32 Idx) const;
+	uint64 GetBitMask(int32 Idx) const;
+
+	/* Mask of the valid cells in word Word of any row */
+	uint64 GetValidMask(int32 Word) const;
+
+	/* Grow RowSeeds in place to every cell of RowMask that's connected to a seed along the row */
+	void FillRow(uint64* RowSeeds, const uint64* RowMask) const;
+
+	/* Build the cascade mask for a row and clear its fill, once the cascade is about to reach it. Rows off the board are ignored */
+	void PrepareCascadeRow(int32 Row);
+
+	/* Spread the cascade into Row from its neighbouring row, then along Row itself. Returns true if anything was added */
+	bool GrowCascadeRow(int32 Row, int32 NeighbourRow);
+
+	/* Compute the word of a row shifted so that every cell sees its left or right neighbour */
+	static uint64 ShiftFromLeft(const uint64* Row, int32 Word);
+	static uint64 ShiftFromRight(const uint64* Row, int32 Word, int32 WordsInRow);
+
+	int32 Width;
+	int32 Height;
+	int32 WordsPerRow;
+	bool bCanPlay;
+
+	// Row-major planes, WordsPerRow words per row
+	TArray<uint64> Mines;
+	TArray<uint64> Flags;
+	TArray<uint64> Activated;
+	TArray<uint64> NearbyCountPlanes[NumCountPlanes];
+
+	// Scratch planes used by the cascade, kept around so reveals don't allocate. Only the rows a cascade reaches are written
+	TArray<uint64> CascadeMask;
+	TArray<uint64> CascadeFill;
+};
@@ -0,0 +1,308 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "MinesweeperRandomStream.h"
+#include "MinesweeperBoard.generated.h"
+
+/* Runtime Cell Data which holds state information for each cell
+ * Packed into a single byte: the low 4 bits hold the nearby mines count (0-8), the rest are state flags.
+ * Row, Col and Index aren't stored, as they all come from the cell's position in the board (see FMinesweeperBoard)
+ */
+USTRUCT()
+struct FCellData
+{
+	GENERATED_BODY()
+	FCellData() : Bits(0) {}
+
+	bool IsFlagged() const
+	{
+		return (Bits & FlaggedBit) != 0;
+	}
+
+	void SetIsFlagged(bool IsFlagged)
+	{
+		Bits = IsFlagged ? (Bits | FlaggedBit) : (Bits & ~FlaggedBit);
+	}
+
+	bool IsMine() const
+	{
+		return (Bits & MineBit) != 0;
+	}
+
+	// Currently, we will never unset a mine, so we use SetMine rather than SetIsMine(bool)
+	void SetMine()
+	{
+		Bits |= MineBit;
+	}
+
+	bool WasActivated() const
+	{
+		return (Bits & ActivatedBit) != 0;
+	}
+
+	void SetActivated()
+	{
+		Bits |= ActivatedBit;
+	}
+
+	// Only undoing a reveal ever hides a cell again
+	void ClearActivated()
+	{
+		Bits &= ~ActivatedBit;
+	}
+
+	// NearbyMinesCount is filled in for every cell when the board is generated, whether it's been activated or not
+	int32 GetNearbyMinesCount() const
+	{
+		return Bits & CountMask;
+	}
+
+	void SetNearbyMinesCount(int32 Mines)
+	{
+		check(Mines >= 0 && Mines <= 8)
+		Bits = (Bits & ~CountMask) | static_cast<uint8>(Mines);
+	}
+
+private:
+	// Converts 8 cells at a time to and from bit planes, which needs to know where each state is kept
+	friend class FMinesweeperSnapshot;
+
+	static constexpr uint8 CountMask = 0x0F;
+	static constexpr uint8 MineBit = 1 << 4;
+	static constexpr uint8 FlaggedBit = 1 << 5;
+	static constexpr uint8 ActivatedBit = 1 << 6;
+
+	uint8 Bits;
+};
+
+static_assert(sizeof(FCellData) == 1, "FCellData is expected to pack into a single byte");
+
+/* What a move does to the cell it's made on */
+enum class EMinesweeperMoveType : uint8
+{
+	/* Reveal the cell, cascading outward if it has no nearby mines */
+	Reveal,
+	/* Flip the flag on a cell that hasn't been revealed */
+	Flag,
+	/* Reveal every neighbour of a revealed number that isn't flagged, once it has as many flags around it as its number */
+	Chord,
+};
+
+/* A single move by a player, a bot or a script, applied to a board in batches by FMinesweeperBoard::ApplyMoves */
+struct FMinesweeperMove
+{
+	FMinesweeperMove()
+		: Type(EMinesweeperMoveType::Reveal)
+		, Idx(INDEX_NONE)
+	{}
+
+	FMinesweeperMove(EMinesweeperMoveType InType, int32 InIdx)
+		: Type(InType)
+		, Idx(InIdx)
+	{}
+
+	EMinesweeperMoveType Type;
+	int32 Idx;
+};
+
+/* Broadcast with every cell whose state changed, after a reveal or a flag */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMinesweeperCellsChanged, TArrayView<const int32> /* ChangedCells */);
+
+/*
+ * Headless Minesweeper board: owns the cell data and the rules of the game.
+ * This has no Slate dependency so that boards can be driven from commandlets and tests,
+ * SMinesweeper only observes it and forwards player input.
+ */
+class MINESWEEPER_API FMinesweeperBoard
+{
+public:
+	FMinesweeperBoard();
+	~FMinesweeperBoard();
+
+	/* Generate the Data used by the grid
+	 * The same seed always generates the same board, including the player hint
+	 * Returns a random index that might be used as a player hint, -1 if we don't have a starting point
+	 */
+	int32 GenerateMinesData(int32 InWidth, int32 InHeight, int32 InMinesCount, uint64 InSeed);
+
+	/* Apply moves in order, in a single pass. Observers hear about the whole batch once, after its last move
+	 * Moves which wouldn't change anything are skipped, and so is everything once a mine has been hit
+	 * Moves to cells outside the board are skipped too, with a warning
+	 * Each move can be undone on its own. Returns the number of cells the batch revealed
+	 */
+	int32 ApplyMoves(TArrayView<const FMinesweeperMove> Moves);
+
+	/* Reveal a cell, cascading outward if it has no nearby mines. Hitting a mine ends the game
+	 * Returns the number of cells this reveal opened, including the cascade
+	 */
+	int32 ActivateCell(int32 Idx);
+
+	/* Activate every cell on the board in a single pass, without any cascading. This ends the game, and never counts as a win */
+	void RevealAll();
+
+	/* Flip the flagged state of a cell, as long as it hasn't been revealed */
+	void ToggleFlag(int32 Idx);
+
+	/* Take back the last reveal or flag, including a reveal that hit a mine, which lets the game carry on
+	 * Costs time in proportion to the cells the move changed. Returns false if there's nothing to undo
+	 */
+	bool Undo();
+
+	/* Make the last undone move again. Making any other move discards the moves that could have been redone
+	 * Returns false if there's nothing to redo
+	 */
+	bool Redo();
+
+	bool CanUndo() const;
+	bool CanRedo() const;
+
+	/* Swap the cells and state of two boards, which lets a board generated on another thread be published in one go
+	 * Observers stay with their own board, and both boards broadcast that they changed
+	 */
+	void SwapBoard(FMinesweeperBoard& Other);
+
+	/* Are we able to play? False once a mine has been hit, or once every safe cell has been revealed */
+	bool CanPlay() const;
+
+	/* Has every cell that isn't a mine been revealed? Counted as cells open, so this is O(1) */
+	bool HasWon() const;
+
+	/* Has a mine been hit? Undoing the move that hit it takes this back */
+	bool HasLost() const;
+
+	int32 GetWidth() const;
+	int32 GetHeight() const;
+	int32 GetMinesCount() const;
+
+	/* Counters kept up to date by every reveal, flag, undo and redo, so none of them need to look at the cells */
+	int32 GetNumSafeCells() const;
+	int32 GetNumRevealedSafeCells() const;
+	int32 GetNumFlags() const;
+
+	/* Mines less flags placed, as shown by the classic counter. Goes negative if the player flags more cells than there are mines */
+	int32 GetNumMinesRemaining() const;
+
+	/* The seed this board was generated from */
+	uint64 GetSeed() const;
+
+	/* Total number of cells on the board */
+	int32 Num() const;
+
+	/* Memory held by the board's cells, scratch space and journal of moves */
+	SIZE_T GetAllocatedSize() const;
+
+	const FCellData& GetCell(int32 Idx) const;
+
+	/* Cells are stored row-major, so their position is derived from the index rather than stored */
+	int32 GetRow(int32 Idx) const;
+	int32 GetCol(int32 Idx) const;
+	int32 GetIndex(int32 Row, int32 Col) const;
+
+	/* Observers are told exactly which cells changed, so they only need to update those rather than polling the board */
+	FOnMinesweeperCellsChanged& OnCellsChanged() { return CellsChangedEvent; }
+
+	/* Broadcast when any cell may have changed: a new game, revealing the whole board, or the game ending */
+	FSimpleMulticastDelegate& OnBoardChanged() { return BoardChangedEvent; }
+
+private:
+	// Times the counting pass on its own, which is otherwise only run as part of generation
+	friend class FMinesweeperBenchmark;
+
+	// Fills in the cells straight from the planes of a snapshot
+	friend class FMinesweeperSnapshot;
+
+	/* Fill in the sum of mines within the adjacent cells for the whole board, done once right after mine placement */
+	void ComputeNearbyMinesCounts();
+
+	/* Activate nearby cells which haven't been activated yet, as long as they're not mines themselves
+	 * Newly activated cells are pushed onto RevealQueue so the cascade can continue from them
+	 */
+	void ActivateNearbyCells(int32 CellIndex);
+
+	/* Each kind of move, adding the cells it changed to RevealQueue and recording itself in the journal
+	 * The reveals return the number of cells they opened
+	 */
+	int32 RevealCell(int32 Idx);
+	int32 ChordCell(int32 Idx);
+	void FlagCell(int32 Idx);
+
+	/* Flood fill outward from the cells queued since FirstQueueIndex, and record them as one move
+	 * Returns the number of cells the move opened
+	 */
+	int32 Cascade(int32 FirstQueueIndex);
+
+	/* End the game on a mine the player revealed */
+	void Detonate(int32 Idx);
+
+	/* Returns a bool if a valid adjacent cell was found, and sets OutIndex to a found adjacent cell */
+	/* This is needed to convert from incoming row/col to a valid index in our data */
+	bool TryGetAdjacentCellIndex(int32 CellIndex, int32 Row, int32 Col, int32& OutIndex) const;
+
+	/* Report any change in GetAllocatedSize to the board memory stat */
+	void UpdateMemoryStats();
+
+	// What a move did, which is all that's needed to take it back or make it again
+	enum class EJournalAction : uint8
+	{
+		// Cells were revealed, by a click and the cascade that followed it
+		Reveal,
+		// A cell's flag was flipped
+		Flag,
+		// A mine was revealed, which ended the game
+		Detonate,
+	};
+
+	// A move recorded in the journal, as the range of JournalCells holding the cells it changed
+	struct FJournalEntry
+	{
+		EJournalAction Action;
+		int32 FirstCell;
+		int32 NumCells;
+	};
+
+	/* Record a move, discarding any moves that were undone before it */
+	void RecordMove(EJournalAction Action, TArrayView<const int32> Cells);
+
+	/* Apply a journal entry to the board forwards for a redo, or backwards for an undo, and broadcast what changed */
+	void ApplyJournalEntry(const FJournalEntry& Entry, bool bForwards);
+
+	/* Forget every move, keeping the journal's allocations for the next game */
+	void ClearJournal();
+
+	int32 Width;
+	int32 Height;
+	int32 MinesCount;
+
+	// False once a mine has been hit. Winning is worked out from the counters instead, so undoing a move can't leave it stale
+	bool bCanPlay;
+
+	// Safe cells revealed and cells flagged, updated by every change to a cell so the game never has to scan the board
+	int32 NumRevealedSafeCells;
+	int32 NumFlags;
+
+	// Every board has its own random stream, so boards are reproducible from their seed and can be generated in parallel
+	FMinesweeperRandomStream RandomStream;
+
+	// row-major ordered array for our mine grid
+	TArray<FCellData> MinesData;
+
+	// Worklist used by the flood fill, which also collects every cell a batch of moves changed so they can be broadcast
+	// together. Kept around so moves don't allocate
+	TArray<int32> RevealQueue;
+
+	// Rolling horizontal sums used by ComputeNearbyMinesCounts, kept around so generating a board doesn't allocate
+	TArray<uint8> HorizontalSums;
+
+	// Every move made this game, in order, and the cells they changed. Memory grows with the cells changed rather than
+	// the size of the board, and undoing a move only touches the cells it changed
+	TArray<FJournalEntry> Journal;
+	TArray<int32> JournalCells;
+
+	// Entries before this have been made, the ones from here on have been undone and can be redone
+	int32 NumAppliedJournalEntries;
+
+	// Memory last reported to the board memory stat, which is taken back out when the board is destroyed
+	SIZE_T ReportedAllocatedSize;
+
+	FOnMinesweeperCellsChanged CellsChangedEvent;
+	FSimpleMulticastDelegate BoardChangedEvent;
+};
@@ -0,0 +1,204 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "MinesweeperBoard.h"
+
+/* Broadcast with the position of every cell whose state changed, after a reveal or a flag */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMinesweeperChunkedCellsChanged, TArrayView<const FIntPoint> /* ChangedCells */);
+
+/*
+ * Headless Minesweeper board for boards far too large to store every cell, up to millions of rows and columns.
+ * Cells are held in square chunks which are only created once a cell in them is looked at. Every chunk places its own
+ * mines from a random stream seeded by the board seed and the chunk's position, so a chunk can be thrown away and
+ * regenerated identically at any time.
+ *
+ * Chunks the player has changed, by revealing or flagging a cell in them, are kept for the rest of the game.
+ * Chunks which have only been looked at are kept in a bounded cache, and the least recently used one is evicted once
+ * it's full. Memory is proportional to the area that has been played, rather than to the size of the board.
+ *
+ * Cells are addressed by position (X is the column, Y is the row), as the number of cells doesn't fit in an int32.
+ *
+ * In infinite mode whether a cell holds a mine is a pure function of the seed and its position, hashed against the
+ * mine density, so nothing about the board is decided up front and it's as large as anyone will ever scroll.
+ */
+class MINESWEEPER_API FMinesweeperChunkedBoard
+{
+public:
+	/* Chunks are ChunkSize x ChunkSize cells */
+	static constexpr int32 ChunkSize = 64;
+
+	/* Width and height of an infinite board. Play starts in the middle, so it's far beyond reach in every direction */
+	static constexpr int32 InfiniteSize = 1 << 30;
+
+	/* Sparsest an infinite board can be. Below about 10% mines the cells without nearby mines join up into a region without
+	 * end, which a single reveal would keep opening until it ran out of memory. At 15% the largest cascades are a few hundred cells
+	 */
+	static constexpr double MinInfiniteMineDensity = 0.15;
+
+	FMinesweeperChunkedBoard();
+	~FMinesweeperChunkedBoard();
+
+	/* Start a new board, which doesn't generate any chunks yet
+	 * The same seed always generates the same board, including the player hint
+	 * The board holds exactly InMinesCount mines, shared between the chunks in proportion to the number of cells in them
+	 * Returns a random cell that might be used as a player hint, FIntPoint::NoneValue if we don't have a starting point
+	 */
+	FIntPoint GenerateMinesData(int32 InWidth, int32 InHeight, int64 InMinesCount, uint64 InSeed);
+
+	/* Start a new infinite board, where each cell is a mine with a probability of InMineDensity. This is O(1)
+	 * Densities below MinInfiniteMineDensity are raised to it, so every cascade comes to an end
+	 * Returns a random cell near the middle of the board that might be used as a player hint
+	 */
+	FIntPoint GenerateInfiniteMinesData(double InMineDensity, uint64 InSeed);
+
+	/* Reveal a cell, cascading outward if it has no nearby mines. Hitting a mine ends the game
+	 * Returns the number of cells this reveal opened, including the cascade
+	 */
+	int32 ActivateCell(const FIntPoint& Cell);
+
+	/* Flip the flagged state of a cell, as long as it hasn't been revealed */
+	void ToggleFlag(const FIntPoint& Cell);
+
+	/* Are we able to play? False once a mine has been hit, or once every safe cell has been revealed */
+	bool CanPlay() const;
+
+	/* Has every cell that isn't a mine been revealed? Never true for an infinite board, as it never runs out of cells */
+	bool HasWon() const;
+
+	/* Has a mine been hit? */
+	bool HasLost() const;
+
+	int32 GetWidth() const;
+	int32 GetHeight() const;
+
+	/* The number of mines on the board, which isn't known for an infinite board and is INDEX_NONE */
+	int64 GetMinesCount() const;
+
+	/* Counters kept up to date by every reveal and flag. The ones that depend on the number of mines are INDEX_NONE
+	 * for an infinite board
+	 */
+	int64 GetNumSafeCells() const;
+	int64 GetNumRevealedSafeCells() const;
+	int64 GetNumFlags() const;
+	int64 GetNumMinesRemaining() const;
+
+	bool IsInfinite() const;
+
+	/* The seed this board was generated from */
+	uint64 GetSeed() const;
+
+	/* Total number of cells on the board */
+	int64 Num() const;
+
+	bool IsValidCell(const FIntPoint& Cell) const;
+
+	/* Cells are returned by value, as looking at a cell may generate its chunk and evict another one */
+	FCellData GetCell(const FIntPoint& Cell) const;
+
+	/* How many chunks the player hasn't changed may be kept around. Changed chunks are never evicted */
+	void SetMaxCachedChunks(int32 InMaxCachedChunks);
+
+	int32 GetNumChunks() const;
+	int32 GetNumCachedChunks() const;
+
+	/* Memory used by the chunks and their bookkeeping, in bytes */
+	SIZE_T GetAllocatedSize() const;
+
+	/* Observers are told exactly which cells changed, so they only need to update those rather than polling the board */
+	FOnMinesweeperChunkedCellsChanged& OnCellsChanged() { return CellsChangedEvent; }
+
+	/* Broadcast when any cell may have changed: a new game, or the game ending */
+	FSimpleMulticastDelegate& OnBoardChanged() { return BoardChangedEvent; }
+
+private:
+	// Stores the chunks the player changed, and puts them back when a snapshot is loaded
+	friend class FMinesweeperSnapshot;
+
+	struct FChunk
+	{
+		// Row-major, ChunkSize cells per row. Chunks along the right and bottom edges leave the cells past the edge unused
+		TArray<FCellData> Cells;
+
+		// Value of UseCounter when the chunk was last looked at, used to find the least recently used chunk
+		uint32 LastUsed;
+
+		// Has the player changed a cell in this chunk? Only untouched chunks can be evicted
+		bool bTouched;
+	};
+
+	/* Returns the chunk holding a cell, generating it if it isn't in memory. This may evict another untouched chunk */
+	FChunk& FindOrGenerateChunk(const FIntPoint& ChunkCoord) const;
+
+	/* Returns a cell the player is about to change, which marks its chunk as touched so it's never evicted */
+	FCellData& GetMutableCell(const FIntPoint& Cell);
+
+	/* Clear every chunk, ready for a new board */
+	void ResetBoard(int32 InWidth, int32 InHeight, uint64 InSeed);
+
+	/* Pick a random cell in the given range which isn't a mine, for the player hint */
+	FIntPoint FindStartingPoint(const FIntPoint& Min, const FIntPoint& Max);
+
+	/* Is a cell of an infinite board a mine? Only depends on the seed and the cell's position */
+	bool IsInfiniteMine(int32 X, int32 Y) const;
+
+	/* Place the chunk's mines and fill in the nearby mines counts of every cell in it */
+	void GenerateChunk(const FIntPoint& ChunkCoord, FChunk& Chunk) const;
+
+	/* Set the mine flag for every mine in a chunk, where OutMines points at the chunk's first cell within rows of Stride cells */
+	void PlaceChunkMines(const FIntPoint& ChunkCoord, uint8* OutMines, int32 Stride) const;
+
+	/* Number of mines in a chunk, taken from the running total over every chunk before it in row-major order */
+	int64 GetChunkMinesCount(const FIntPoint& ChunkCoord) const;
+
+	/* Number of valid cells in a chunk, which is only less than ChunkSize x ChunkSize along the right and bottom edges */
+	FIntPoint GetChunkCellsSize(const FIntPoint& ChunkCoord) const;
+
+	/* Activate nearby cells which haven't been activated yet, as long as they're not mines themselves
+	 * Newly activated cells are pushed onto RevealQueue so the cascade can continue from them
+	 */
+	void ActivateNearbyCells(const FIntPoint& Cell);
+
+	/* Report any change in GetAllocatedSize to the board memory stat */
+	void UpdateMemoryStats() const;
+
+	int32 Width;
+	int32 Height;
+	int64 MinesCount;
+
+	// False once a mine has been hit, winning is worked out from the counters
+	bool bCanPlay;
+
+	// Safe cells revealed and cells flagged, as the board is far too large to count them
+	int64 NumRevealedSafeCells;
+	int64 NumFlags;
+
+	// An infinite board's cells are mines when the hash of their position is below this
+	bool bInfinite;
+	uint64 MineThreshold;
+	int32 MaxCachedChunks;
+
+	// Chunk mines come from their own streams, this one is only used to pick the player hint
+	FMinesweeperRandomStream RandomStream;
+
+	// Every chunk in memory, keyed by its position in chunks. Chunks are heap allocated so references stay valid as the map grows
+	mutable TMap<FIntPoint, TUniquePtr<FChunk>> Chunks;
+
+	// Chunks which haven't been touched, which are the only ones we may evict
+	mutable TArray<FIntPoint> CachedChunks;
+	mutable uint32 UseCounter;
+
+	// Chunk found by the last lookup, as lookups nearly always land in the same chunk as the one before
+	mutable FIntPoint LastChunkCoord;
+	mutable FChunk* LastChunk;
+
+	// Mines of the 3x3 chunks around a chunk being generated, kept around so generating a chunk doesn't allocate
+	mutable TArray<uint8> MinesScratch;
+
+	// Worklist used by the ActivateCell flood fill, kept around so reveals don't allocate
+	TArray<FIntPoint> RevealQueue;
+
+	// Memory last reported to the board memory stat, which is taken back out when the board is destroyed
+	mutable SIZE_T ReportedAllocatedSize;
+
+	FOnMinesweeperChunkedCellsChanged CellsChangedEvent;
+	FSimpleMulticastDelegate BoardChangedEvent;
+};
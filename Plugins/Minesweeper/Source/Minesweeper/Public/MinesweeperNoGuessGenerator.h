@@ -0,0 +1,30 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+/*
+ * Finds boards which can be solved from the player hint without ever having to guess.
+ * Candidate boards are generated from seeds derived from the requested seed, and each is played out by
+ * FMinesweeperSolver from its hint, revealing every cell it can prove is safe until it gets stuck or clears the board.
+ *
+ * Candidates are checked in parallel on every worker thread, and candidates after one that has already been found
+ * solvable are skipped. The first solvable candidate in order always wins however the work was scheduled,
+ * so the same seed always finds the same board.
+ */
+class MINESWEEPER_API FMinesweeperNoGuessGenerator
+{
+public:
+	/* Candidates tried before giving up, which is plenty for expert density */
+	static constexpr int32 DefaultMaxAttempts = 100000;
+
+	/* Returns the seed of the first candidate which can be solved without guessing, or an unset optional if
+	 * none of MaxAttempts candidates could be. Generating a board from the returned seed gives the solvable board
+	 * bCancel is checked between candidates, and stops the search early if it's set
+	 */
+	static TOptional<uint64> FindSeed(int32 Width, int32 Height, int32 MinesCount, uint64 Seed, int32 MaxAttempts = DefaultMaxAttempts, const TAtomic<bool>* bCancel = nullptr);
+
+	/* Can the board generated from this seed be solved from its hint without guessing? */
+	static bool IsSolvableWithoutGuessing(int32 Width, int32 Height, int32 MinesCount, uint64 Seed);
+
+	/* The seed of a candidate. The first candidate is the seed itself, so a seed that's already solvable is kept */
+	static uint64 GetCandidateSeed(uint64 Seed, int32 Attempt);
+};
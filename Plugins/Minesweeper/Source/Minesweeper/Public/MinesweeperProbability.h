@@ -0,0 +1,110 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "MinesweeperRandomStream.h"
+
+class FMinesweeperBoard;
+class FMinesweeperSolver;
+
+/*
+ * Works out the exact probability of every unrevealed cell being a mine, from what the player can see.
+ *
+ * Unknown cells next to a revealed number make up the frontier, which is split into components that share no
+ * constraints, so each can be enumerated on its own. Each component is enumerated with backtracking, counting the
+ * solutions and how often each cell is a mine in them, grouped by how many mines the solution uses. Components are
+ * then combined, weighting every total by the number of ways the remaining mines can be placed in the cells away from
+ * the frontier, which is a binomial count.
+ *
+ * Components are remembered between computes, so after a move only the components the move changed are enumerated
+ * again. Components too large to enumerate within MaxEnumerationSteps are sampled instead, and the result is approximate.
+ * Samples aren't drawn uniformly from the solutions, so the probabilities of a sampled component are biased as well.
+ */
+class MINESWEEPER_API FMinesweeperProbability
+{
+public:
+	/* Backtracking steps allowed for a single component before it's sampled instead */
+	static constexpr int32 MaxEnumerationSteps = 1 << 18;
+
+	/* Solutions drawn for a component that's sampled, each allowed SampleStepsPerCell steps for every cell in the component */
+	static constexpr int32 NumSamples = 256;
+	static constexpr int32 SampleStepsPerCell = 16;
+
+	FMinesweeperProbability();
+
+	/* Work out the probabilities from the board, using the cells the solver has already deduced
+	 * The solver should be up to date with the board, so call Solve on it first
+	 */
+	void Compute(const FMinesweeperBoard& Board, const FMinesweeperSolver& Solver);
+
+	/* Probability that a cell is a mine, as of the last compute. Revealed cells are never mines */
+	float GetMineProbability(int32 Idx) const;
+	TArrayView<const float> GetMineProbabilities() const;
+
+	/* Was every component enumerated exactly? False if any had to be sampled, in which case the probabilities are only
+	 * an approximation, and lean towards the solutions the sampling finds most easily
+	 */
+	bool IsExact() const;
+
+	/* Forget every remembered component */
+	void Reset();
+
+private:
+	/* A set of frontier cells connected by constraints, with the solutions found for it */
+	struct FComponent
+	{
+		// Identifies the component's cells and constraints, so it can be reused when they haven't changed
+		TArray<int32> Key;
+		uint32 KeyHash;
+
+		// Cells in the order they're enumerated, and each constraint as the local indices of its cells and its mines
+		TArray<int32> Cells;
+		TArray<TArray<int32>> ConstraintCells;
+		TArray<int32> ConstraintMines;
+
+		// Weights[K] is the number of solutions using MinMines + K mines, and CellWeights[K * Cells.Num() + I] the number of
+		// those where cell I is a mine. Both are scaled so that the largest weight is 1, as there can be far too many to count.
+		// Only the mine counts solutions were found for are kept, as a component can have thousands of cells
+		TArray<double> Weights;
+		TArray<double> CellWeights;
+		int32 MinMines;
+
+		bool bExact;
+	};
+
+	/* Count the solutions of a component, exactly if we can or by sampling if there are too many */
+	void SolveComponent(FComponent& Component, uint64 Seed) const;
+
+	/* Depth first enumeration of every assignment of the cells. Returns false if we ran out of steps
+	 * Components can have thousands of cells, so the search keeps its place in Attempts rather than on the stack
+	 */
+	bool Enumerate(FComponent& Component, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft, TArray<uint8>& Assignment, int32& StepsLeft) const;
+
+	/* Draw a solution by depth first search in the same cell order as the enumeration, trying a mine or no mine first at random
+	 * for each cell. This isn't a uniform draw from the solutions, as the ones the first choices lead to are favoured.
+	 * Returns false if we ran out of steps
+	 */
+	bool Sample(FComponent& Component, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft, TArray<uint8>& Assignment, int32& StepsLeft, FMinesweeperRandomStream& Stream) const;
+
+	/* Take back the assignments of every cell before CellIndex, so a search that stopped part way leaves a clean slate */
+	void UnassignAll(const FComponent& Component, int32 CellIndex, const TArray<uint8>& Assignment, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft) const;
+
+	/* Assign a cell, updating its constraints. Returns false if that breaks a constraint, in which case nothing is changed */
+	bool Assign(int32 CellIndex, uint8 bMine, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft) const;
+	void Unassign(const FComponent& Component, int32 CellIndex, uint8 bMine, TArray<int32>& ConstraintMinesLeft, TArray<int32>& ConstraintCellsLeft) const;
+
+	/* Add a complete assignment to the component's weights */
+	void Record(FComponent& Component, const TArray<uint8>& Assignment, int32 NumMines) const;
+
+	/* Widen the mine counts the component's weights cover so that NumMines is one of them */
+	void GrowWeights(FComponent& Component, int32 NumMines) const;
+
+	// Constraints each cell of the component being solved belongs to, by local index
+	mutable TArray<TArray<int32>> CellConstraints;
+
+	// How many of its two values each cell of the search has tried, and which one it tried first
+	mutable TArray<uint8> Attempts;
+	mutable TArray<uint8> FirstAttempts;
+
+	TArray<FComponent> Components;
+	TArray<float> Probabilities;
+	bool bExact;
+};
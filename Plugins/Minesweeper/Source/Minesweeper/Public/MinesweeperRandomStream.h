@@ -0,0 +1,103 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+/*
+ * Small, fast random stream owned by each board, modelled on FRandomStream but with a 64-bit seed.
+ * It's a xoshiro256** generator whose state is expanded from the seed with SplitMix64, so the same seed always
+ * produces the same sequence on every platform, and boards never share random state with each other.
+ */
+class MINESWEEPER_API FMinesweeperRandomStream
+{
+public:
+	FMinesweeperRandomStream()
+	{
+		Initialize(0);
+	}
+
+	explicit FMinesweeperRandomStream(uint64 InSeed)
+	{
+		Initialize(InSeed);
+	}
+
+	void Initialize(uint64 InSeed)
+	{
+		InitialSeed = InSeed;
+
+		uint64 SplitMixState = InSeed;
+		for (uint64& Word : State)
+		{
+			Word = SplitMix64(SplitMixState);
+		}
+	}
+
+	uint64 GetInitialSeed() const
+	{
+		return InitialSeed;
+	}
+
+	/* Returns the next 64 random bits in the stream */
+	uint64 GetUnsignedInt64()
+	{
+		const uint64 Result = RotateLeft(State[1] * 5, 7) * 9;
+		const uint64 Shifted = State[1] << 17;
+
+		State[2] ^= State[0];
+		State[3] ^= State[1];
+		State[1] ^= State[2];
+		State[0] ^= State[3];
+		State[2] ^= Shifted;
+		State[3] = RotateLeft(State[3], 45);
+
+		return Result;
+	}
+
+	/* Returns a uniformly distributed integer in [Min, Max] */
+	int32 RandRange(int32 Min, int32 Max)
+	{
+		check(Min <= Max)
+
+		const uint64 Range = uint64(int64(Max) - int64(Min)) + 1;
+
+		// Reject the few values at the bottom of the 64-bit range that would make the modulo biased
+		const uint64 Threshold = (0 - Range) % Range;
+		uint64 Value = GetUnsignedInt64();
+		while (Value < Threshold)
+		{
+			Value = GetUnsignedInt64();
+		}
+
+		return static_cast<int32>(int64(Min) + int64(Value % Range));
+	}
+
+	/* Scramble a value into 64 well distributed bits, so nearby inputs give unrelated outputs
+	 * This is the SplitMix64 finalizer, which makes it a cheap hash of a position or a counter
+	 */
+	static uint64 Mix(uint64 Value)
+	{
+		Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+		return Value ^ (Value >> 31);
+	}
+
+	/* Make a fresh seed for when the player doesn't provide one */
+	static uint64 MakeSeed()
+	{
+		static uint64 Counter = 0;
+		uint64 SplitMixState = FPlatformTime::Cycles64() ^ (++Counter * 0x9E3779B97F4A7C15ull);
+		return SplitMix64(SplitMixState);
+	}
+
+private:
+	static uint64 RotateLeft(uint64 Value, int32 Shift)
+	{
+		return (Value << Shift) | (Value >> (64 - Shift));
+	}
+
+	static uint64 SplitMix64(uint64& InOutState)
+	{
+		return Mix(InOutState += 0x9E3779B97F4A7C15ull);
+	}
+
+	uint64 InitialSeed;
+	uint64 State[4];
+};
@@ -0,0 +1,149 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+class FMinesweeperBoard;
+class IFileHandle;
+
+/* What a recorded input did: a move made on the board, or taking one back and making it again */
+enum class EMinesweeperInputType : uint8
+{
+	Reveal,
+	Flag,
+	Chord,
+	Undo,
+	Redo,
+};
+
+/* An input as it was recorded. Undo and redo aren't made on a cell, so their Idx is INDEX_NONE */
+struct FMinesweeperRecordedInput
+{
+	FMinesweeperRecordedInput()
+		: Seconds(0.0)
+		, Type(EMinesweeperInputType::Reveal)
+		, Idx(INDEX_NONE)
+	{}
+
+	/* Time since the game started */
+	double Seconds;
+
+	EMinesweeperInputType Type;
+	int32 Idx;
+};
+
+/* A game as the board it was dealt and every input made on it, which plays out exactly the same every time */
+struct FMinesweeperRecordedGame
+{
+	FMinesweeperRecordedGame()
+		: Width(0)
+		, Height(0)
+		, MinesCount(0)
+		, Seed(0)
+	{}
+
+	int32 Width;
+	int32 Height;
+	int32 MinesCount;
+	uint64 Seed;
+
+	TArray<FMinesweeperRecordedInput> Inputs;
+
+	/* Seconds from the start of the game to its last input */
+	double GetDuration() const;
+};
+
+/*
+ * Records the inputs made on a board into an append-only log, which FMinesweeperReplay plays back.
+ *
+ * A log starts with a magic number and version. Every game in it starts with its board's size and seed, and every input
+ * after that is a type followed by the milliseconds since the last input and the cell, as variable length integers, so
+ * most inputs take 3 to 5 bytes. Each input is written to the file as it's made, so a log is complete up to the last
+ * input even if the editor goes down partway through a game.
+ */
+class MINESWEEPER_API FMinesweeperRecorder
+{
+public:
+	/* Bumped whenever the layout changes. Logs of any other version are refused rather than misread */
+	static constexpr uint16 Version = 1;
+
+	FMinesweeperRecorder();
+	~FMinesweeperRecorder();
+
+	/* Where the editor records every game played in it, in the project's Saved directory */
+	static FString GetDefaultFilename();
+
+	/* Start appending to a log, which is created along with its directory if it doesn't exist yet */
+	bool Open(const TCHAR* Filename);
+	void Close();
+	bool IsOpen() const;
+
+	/* Start recording a new game. Boards are dealt from their size and seed, which is all a replay needs to deal it again */
+	void BeginGame(int32 Width, int32 Height, int32 MinesCount, uint64 Seed);
+
+	/* Stop recording until the next game, for boards that can't be dealt again from a seed, such as a loaded snapshot */
+	void EndGame();
+
+	bool IsRecordingGame() const;
+
+	/* Record an input made on the current game, timed from the start of the game. Ignored between games */
+	void RecordInput(EMinesweeperInputType Type, int32 Idx = INDEX_NONE);
+
+private:
+	/* Write out everything buffered since the last flush */
+	void Flush();
+
+	TUniquePtr<IFileHandle> FileHandle;
+
+	// Bytes waiting to be written, kept around so recording an input doesn't allocate
+	TArray<uint8> Buffer;
+
+	bool bRecordingGame;
+	double GameStartSeconds;
+	uint32 LastInputMilliseconds;
+};
+
+/* Result of replaying a recorded game as fast as it can be played */
+struct FMinesweeperReplayResult
+{
+	FMinesweeperReplayResult()
+		: NumInputs(0)
+		, NumCellsRevealed(0)
+		, bWon(false)
+		, bLost(false)
+		, Seconds(0.0)
+	{}
+
+	int32 NumInputs;
+	int32 NumCellsRevealed;
+
+	/* Did the game end with every safe cell revealed, or on a mine? Neither if the player stopped partway through */
+	bool bWon;
+	bool bLost;
+
+	/* Time taken to play the inputs, not including dealing the board */
+	double Seconds;
+
+	FString ToString(const FMinesweeperRecordedGame& Game) const;
+};
+
+/*
+ * Plays back the games in a log recorded by FMinesweeperRecorder, either all at once or a few inputs at a time.
+ * Runs of moves between undos and redos are applied as one batch, which ends in the same board as applying them one at a time.
+ */
+class MINESWEEPER_API FMinesweeperReplay
+{
+public:
+	/* Read every game in a log. A log that was cut off partway through an input keeps every input before it
+	 * Returns false if the data isn't a log, or holds an input that can't be played on its board
+	 */
+	static bool Parse(TArrayView<const uint8> Data, TArray<FMinesweeperRecordedGame>& OutGames);
+	static bool LoadFromFile(const TCHAR* Filename, TArray<FMinesweeperRecordedGame>& OutGames);
+
+	/* Deal a recorded game's board, ready for its inputs */
+	static void DealBoard(const FMinesweeperRecordedGame& Game, FMinesweeperBoard& Board);
+
+	/* Play some of a game's inputs on its board, in order. Returns the number of cells they revealed */
+	static int32 ApplyInputs(TArrayView<const FMinesweeperRecordedInput> Inputs, FMinesweeperBoard& Board);
+
+	/* Deal a game's board and play every one of its inputs as fast as possible */
+	static FMinesweeperReplayResult Play(const FMinesweeperRecordedGame& Game, FMinesweeperBoard& Board);
+};
@@ -0,0 +1,102 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+class FMinesweeperBoard;
+class FMinesweeperSolver;
+class FMinesweeperProbability;
+
+/* The board to simulate, and how many games to play on it */
+struct FMinesweeperSimulationConfig
+{
+	FMinesweeperSimulationConfig()
+		: Width(30)
+		, Height(16)
+		, MinesCount(99)
+		, NumGames(1000)
+		, Seed(0)
+	{}
+
+	FMinesweeperSimulationConfig(int32 InWidth, int32 InHeight, int32 InMinesCount, int32 InNumGames, uint64 InSeed)
+		: Width(InWidth)
+		, Height(InHeight)
+		, MinesCount(InMinesCount)
+		, NumGames(InNumGames)
+		, Seed(InSeed)
+	{}
+
+	int32 Width;
+	int32 Height;
+	int32 MinesCount;
+	int32 NumGames;
+
+	/* Every game's seed is derived from this, so the same config always plays the same games */
+	uint64 Seed;
+};
+
+/* Totals over every game of a simulation */
+struct FMinesweeperSimulationResult
+{
+	FMinesweeperSimulationResult()
+		: NumGames(0)
+		, NumWins(0)
+		, NumReveals(0)
+		, NumCellsRevealed(0)
+		, NumGuesses(0)
+		, NumCascades(0)
+		, NumCascadeCells(0)
+		, MaxCascadeSize(0)
+		, Seconds(0.0)
+	{}
+
+	FMinesweeperSimulationConfig Config;
+
+	int32 NumGames;
+	int32 NumWins;
+
+	/* Calls to ActivateCell, and the cells they opened between them */
+	int64 NumReveals;
+	int64 NumCellsRevealed;
+
+	/* Reveals made when the solver couldn't prove any cell was safe */
+	int64 NumGuesses;
+
+	/* Reveals which opened more than the cell itself, and the cells they opened */
+	int64 NumCascades;
+	int64 NumCascadeCells;
+	int32 MaxCascadeSize;
+
+	/* Wall clock time taken to play every game */
+	double Seconds;
+
+	float GetWinRate() const;
+	double GetAverageReveals() const;
+	double GetAverageCascadeSize() const;
+	double GetGamesPerSecond() const;
+	double GetCellsPerSecond() const;
+
+	/* One line summary, for logs */
+	FString ToString() const;
+};
+
+/*
+ * Plays seeded games from start to finish without any UI, to measure the engine and to tune difficulty presets.
+ * Games are played by a bot which starts from the player hint, reveals every cell FMinesweeperSolver proves is safe,
+ * and when it's stuck guesses the cell FMinesweeperProbability finds least likely to be a mine.
+ *
+ * Games are spread over every worker thread. Each task keeps one board, solver and probability engine and plays
+ * games until there are none left, so boards aren't reallocated between games of the same size.
+ */
+class MINESWEEPER_API FMinesweeperSimulation
+{
+public:
+	/* Play every game of a config, blocking until they're done */
+	static FMinesweeperSimulationResult Run(const FMinesweeperSimulationConfig& Config);
+
+	/* Play a single game with the bot, adding its stats to OutResult. Returns true if the bot won
+	 * The board is regenerated from the seed, and the solver and probability engine must be following it
+	 */
+	static bool PlayGame(FMinesweeperBoard& Board, FMinesweeperSolver& Solver, FMinesweeperProbability& Probability, const FMinesweeperSimulationConfig& Config, uint64 Seed, FMinesweeperSimulationResult& OutResult);
+
+	/* The seed of one of a config's games */
+	static uint64 GetGameSeed(uint64 Seed, int32 Game);
+};
@@ -0,0 +1,43 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+class FMinesweeperBoard;
+class FMinesweeperChunkedBoard;
+
+/*
+ * Versioned binary snapshots of a board in progress, which can be saved at any point and loaded to carry on playing.
+ *
+ * A snapshot is a fixed size header followed by bit planes, stored as little endian 64-bit words so a snapshot can be
+ * read straight out of a memory-mapped file. A board stores its mine, flag and revealed planes, one bit per cell, and
+ * a plane with nothing set is left out altogether, so a board nobody has played yet costs 1 bit per cell.
+ * A chunked board only stores the chunks the player has changed, with their flag and revealed planes. Their mines, and
+ * every other chunk, are generated again from the seed, so a snapshot of a huge board is proportional to what was played.
+ *
+ * Nearby mine counts aren't stored either, they're counted again from the mine plane when a snapshot is loaded.
+ */
+class MINESWEEPER_API FMinesweeperSnapshot
+{
+public:
+	/* Bumped whenever the layout changes. Snapshots of any other version are refused rather than misread */
+	static constexpr uint16 Version = 1;
+
+	static void Save(const FMinesweeperBoard& Board, TArray<uint8>& OutData);
+	static void Save(const FMinesweeperChunkedBoard& Board, TArray<uint8>& OutData);
+
+	/* Replace a board with the one in a snapshot, which it broadcasts as a new game with nothing to undo
+	 * Returns false without touching the board if the data isn't a valid snapshot of this kind of board
+	 */
+	static bool Load(TArrayView<const uint8> Data, FMinesweeperBoard& OutBoard);
+	static bool Load(TArrayView<const uint8> Data, FMinesweeperChunkedBoard& OutBoard);
+
+	static bool SaveToFile(const FMinesweeperBoard& Board, const TCHAR* Filename);
+	static bool SaveToFile(const FMinesweeperChunkedBoard& Board, const TCHAR* Filename);
+
+	/* Call Visitor with the contents of a file, memory-mapped where the platform can so nothing is copied or parsed
+	 * Returns what Visitor returned, or false if the file couldn't be read
+	 */
+	static bool ReadFile(const TCHAR* Filename, TFunctionRef<bool(TArrayView<const uint8>)> Visitor);
+
+	/* Does the data hold a snapshot of a chunked board, rather than of a board? */
+	static bool IsChunkedSnapshot(TArrayView<const uint8> Data);
+};
@@ -0,0 +1,115 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+
+class FMinesweeperBoard;
+
+/* What the solver knows about a cell. Revealed cells are always Safe */
+enum class EMinesweeperCellKnowledge : uint8
+{
+	Unknown,
+	Safe,
+	Mine,
+};
+
+/*
+ * Deduces every cell that is certainly safe or certainly a mine from what the player can see of a board.
+ * Every revealed cell with a number is a constraint: the unknown cells around it hold exactly as many mines as its
+ * number, less the mines already deduced around it. Constraints are solved on their own first (all safe or all mines),
+ * and then in pairs, where the cells one constraint has that another doesn't can be forced to be all mines or all safe.
+ *
+ * The solver listens to the board, and only the constraints around cells which were revealed or deduced are looked at
+ * again, so a move costs time proportional to the cells it changed rather than to the board.
+ * Every deduction remembers the constraints it was made from, so an undo which hides cells again only takes back what was
+ * deduced from around them, and whatever was deduced from that in turn.
+ * Flags are ignored, as the player may have placed them wrongly.
+ */
+class MINESWEEPER_API FMinesweeperSolver
+{
+public:
+	explicit FMinesweeperSolver(FMinesweeperBoard& InBoard);
+	~FMinesweeperSolver();
+
+	/* Forget everything and start again from the whole board, which happens by itself for a new game */
+	void Reset();
+
+	/* Deduce everything we can from the constraints which changed since the last solve
+	 * Returns true if anything new was deduced
+	 */
+	bool Solve();
+
+	EMinesweeperCellKnowledge GetKnowledge(int32 Idx) const;
+
+	/* Cells which aren't revealed yet and are certainly safe, as of the last solve */
+	const TArray<int32>& GetSafeCells() const;
+
+	/* Cells which are certainly mines */
+	const TArray<int32>& GetMineCells() const;
+
+private:
+	typedef TArray<int32, TInlineAllocator<8>> FCellList;
+
+	/* The constraints a deduction was made from, the second only for deductions made from a pair. Cells we know about
+	 * because they're revealed have neither, which is how a cell hidden again by an undo is told apart from a flagged one
+	 */
+	struct FDeductionReason
+	{
+		FDeductionReason()
+			: Constraint(INDEX_NONE)
+			, OtherConstraint(INDEX_NONE)
+		{}
+
+		FDeductionReason(int32 InConstraint, int32 InOtherConstraint)
+			: Constraint(InConstraint)
+			, OtherConstraint(InOtherConstraint)
+		{}
+
+		int32 Constraint;
+		int32 OtherConstraint;
+	};
+
+	/* Board events, which queue the constraints around the cells that were revealed, and forget what an undo invalidated */
+	void HandleCellsChanged(TArrayView<const int32> ChangedCells);
+	void HandleBoardChanged();
+
+	/* Queue the constraint of a revealed cell to be looked at by the next solve */
+	void QueueConstraint(int32 Idx);
+
+	/* Queue the constraints of every revealed cell around a cell whose knowledge changed */
+	void QueueConstraintsAround(int32 Idx);
+
+	/* Record that a cell is certainly safe or a mine, and queue the constraints it affects */
+	void Deduce(int32 Idx, EMinesweeperCellKnowledge NewKnowledge, const FDeductionReason& Reason);
+
+	/* Take back what we knew about each cell in ForgottenCells, along with every deduction that relied on it,
+	 * and queue the constraints around them to deduce again whatever still holds
+	 */
+	void ForgetCells();
+
+	/* Collect the unknown cells around a revealed cell, returning the number of mines still to be placed among them */
+	int32 GetConstraint(int32 Idx, FCellList& OutUnknownCells) const;
+
+	/* Apply the rules to a single constraint, and then to it paired with every constraint it shares cells with */
+	bool SolveConstraint(int32 Idx);
+
+	/* If the cells only B has must hold every mine B has that A can't, those are mines and the cells only A has are safe */
+	bool SolvePair(const FCellList& CellsA, int32 MinesA, const FCellList& CellsB, int32 MinesB, const FDeductionReason& Reason);
+
+	bool IsRevealed(int32 Idx) const;
+
+	FMinesweeperBoard& Board;
+
+	TArray<EMinesweeperCellKnowledge> Knowledge;
+
+	// Why each cell we deduced is known, kept for every cell so taking a deduction back never has to search for it
+	TArray<FDeductionReason> Reasons;
+
+	// Cells whose knowledge is being taken back, kept around so an undo doesn't allocate
+	TArray<int32> ForgottenCells;
+
+	// Constraints waiting to be looked at, and whether each cell is already waiting so it's never queued twice
+	TArray<int32> QueuedConstraints;
+	TArray<bool> IsQueued;
+
+	TArray<int32> SafeCells;
+	TArray<int32> MineCells;
+};
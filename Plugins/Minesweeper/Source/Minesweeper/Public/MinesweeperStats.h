@@ -0,0 +1,36 @@
+﻿#pragma once
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+
+/*
+ * Stats for the hot paths of the game, shown with "stat Minesweeper" and as timers in Unreal Insights.
+ * Cycle counters cover whole operations, and the steps inside them have their own trace scopes, so a slow new game
+ * or a slow click can be followed down to where the time went.
+ */
+DECLARE_STATS_GROUP(TEXT("Minesweeper"), STATGROUP_Minesweeper, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Grid"), STAT_MinesweeperGenerateGrid, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Mines Data"), STAT_MinesweeperGenerateMinesData, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Count Nearby Mines"), STAT_MinesweeperCountNearbyMines, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Chunk"), STAT_MinesweeperGenerateChunk, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Activate Cell"), STAT_MinesweeperActivateCell, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Moves"), STAT_MinesweeperApplyMoves, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve"), STAT_MinesweeperSolve, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Compute Probabilities"), STAT_MinesweeperComputeProbabilities, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find No Guessing Seed"), STAT_MinesweeperFindNoGuessingSeed, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Paint Board"), STAT_MinesweeperPaintBoard, STATGROUP_Minesweeper, MINESWEEPER_API);
+
+/* Cells opened by the most recent reveal, including its cascade */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Last Cascade Size"), STAT_MinesweeperLastCascadeSize, STATGROUP_Minesweeper, MINESWEEPER_API);
+
+/* Board views alive. Cells are painted rather than being widgets, so this is the whole widget cost of the boards */
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Board Views"), STAT_MinesweeperBoardViews, STATGROUP_Minesweeper, MINESWEEPER_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cells Revealed"), STAT_MinesweeperCellsRevealed, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Moves Applied"), STAT_MinesweeperMovesApplied, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cells Painted"), STAT_MinesweeperCellsPainted, STATGROUP_Minesweeper, MINESWEEPER_API);
+
+/* Memory held by every board, and by the display state the board views cache */
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Board Memory"), STAT_MinesweeperBoardMemory, STATGROUP_Minesweeper, MINESWEEPER_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Board View Memory"), STAT_MinesweeperBoardViewMemory, STATGROUP_Minesweeper, MINESWEEPER_API);
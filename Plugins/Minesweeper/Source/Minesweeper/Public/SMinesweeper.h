@@ -1,138 +1,189 @@
-﻿#pragma once
-#include "SMinesweeper.generated.h"
-
-/* Runtime Cell Data which holds state information for each cell */
-USTRUCT()
-struct FCellData
-{
-	GENERATED_BODY()
-	FCellData() : Row(0), Col(0), Idx(-1), bIsFlagged(false), bIsMine(false), NearbyMinesCount(-1) {}
-	FCellData(int32 Row, int32 Col, int32 Idx, bool bIsFlagged = false, bool bIsMine = false, int32 NearbyMines = -1) : Row(Row), Col(Col), Idx(Idx), bIsFlagged(bIsFlagged), bIsMine(bIsMine), NearbyMinesCount(NearbyMines) {}
-
-	int32 GetRow() const
-	{
-		return Row;
-	}
-
-	int32 GetCol() const
-	{
-		return Col;
-	}
-
-	int32 GetIndex() const
-	{
-		return Idx;
-	}
-
-	bool IsFlagged() const
-	{
-		return bIsFlagged;
-	}
-
-	void SetIsFlagged(bool IsFlagged)
-	{
-		bIsFlagged = IsFlagged;
-	}
-
-	int32 IsMine() const
-	{
-		return bIsMine;
-	}
-
-	// Currently, we will never unset a mine, so we use SetMine rather than SetIsMine(bool)
-	void SetMine()
-	{
-		bIsMine = true;
-	}
-
-	// NearbyMinesCount will only be set if we've activated it before and performed a sweep of adjacent cells
-	bool WasActivated() const
-	{
-		return GetNearbyMinesCount() > -1;
-	}
-
-	int32 GetNearbyMinesCount() const
-	{
-		return NearbyMinesCount;
-	}
-
-	void SetNearbyMinesCount(int32 Mines)
-	{
-		NearbyMinesCount = Mines;
-	}
-	
-private:
-	int32 Row;
-	int32 Col;
-	int32 Idx;
-	bool bIsFlagged;
-	bool bIsMine;
-	int32 NearbyMinesCount;
-};
-
-class SMinesweeper : public SCompoundWidget
-{
-public:
-	SLATE_BEGIN_ARGS( SMinesweeper ){}
-	SLATE_END_ARGS()
-
-	void Construct(const FArguments& InArgs);
-
-private:
-	TSharedRef<SWidget> ConstructCellButton(int32 Idx);
-
-	/* GenerateGrid is equivalent to starting a new game */
-	void GenerateGrid();
-
-	/* Generate the Data used by the grid
-	 * Returns a random index that might be used as a player hint, -1 if we don't have a starting point
-	 */
-	int32 GenerateMinesData();
-
-	/* Find the sum of mines within the adjacent cells */
-	int32 FindNearbyMinesCount(int32 CellIndex);
-
-	/* Activate nearby cells which haven't been activated yet, as long as they're not mines themselves */
-	void ActivateNearbyCells(int32 CellIndex);
-
-	/* Are we able to play? This controls the disabled state of the grid buttons */
-	bool CanPlay() const;
-
-	void ActivateCell(int32 Idx);
-
-	/* Returns a bool if a valid adjacent cell was found, and sets OutIndex to a found adjacent cell */
-	/* This is needed to convert from incoming row/col to a valid index in our data */
-	bool TryGetAdjacentCellIndex(const FCellData* CurrentCell, int32 Row, int32 Col, int32& OutIndex) const;
-	
-	int32 GetDesiredWidth() const;
-	void OnDesiredWidthChanged(int32 NewVal);
-
-	int32 GetDesiredHeight() const;
-	void OnDesiredHeightChanged(int32 NewVal);
-	
-	int32 GetDesiredMinesNum() const;
-    void OnDesiredMinesNumChanged(int32 NewVal);
-
-	bool IsDebugMinesEnabled() const;
-	ECheckBoxState GetDebugMinesState() const;
-	void OnDebugMinesChanged(ECheckBoxState NewState);
-
-	bool IsPlayerHintEnabled() const;
-	ECheckBoxState GetPlayerHintState() const;
-	void OnPlayerHintChanged(ECheckBoxState NewState);
-
-	FReply OnGenerateGridClicked();
-
-	// The Only widget we may want to reference later, as we dynamically add / clear children
-	TSharedPtr<class SUniformGridPanel> GridPanel;
-
-	int32 DesiredWidth;
-	int32 DesiredHeight;
-	int32 DesiredMinesCount;
-	bool bCanPlay;
-	ECheckBoxState DebugMinesState;
-	ECheckBoxState PlayerHintState;
-	
-	// row-major ordered array for our mine grid
-	TArray<FCellData> MinesData;
-};
+﻿#pragma once
+#include "MinesweeperBoard.h"
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperProbability.h"
+#include "MinesweeperRecording.h"
+#include "MinesweeperSolver.h"
+
+struct FMinesweeperPendingBoard;
+
+class SMinesweeper : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS( SMinesweeper ){}
+	SLATE_END_ARGS()
+
+	SMinesweeper();
+	virtual ~SMinesweeper();
+
+	void Construct(const FArguments& InArgs);
+
+private:
+	/* GenerateGrid is equivalent to starting a new game, the same seed always generates the same board
+	 * Boards which hold every cell are generated in the background, and the current board is kept until the new one is ready
+	 */
+	void GenerateGrid(uint64 Seed);
+
+	/* Is a new board being generated in the background? Input is ignored until it's published */
+	bool IsGenerating() const;
+
+	/* Stop waiting for the board being generated, if there is one. The task finishes on its own and its board is thrown away */
+	void CancelGeneration();
+
+	/* Publish the board being generated once it's ready */
+	EActiveTimerReturnType UpdateGeneration(double InCurrentTime, float InDeltaTime);
+
+	/* Is a recorded game being replayed? Input is ignored until it's done, or until a new game or a loaded one replaces it */
+	bool IsReplaying() const;
+	void StopReplay();
+
+	/* Play the inputs of the replayed game whose time has come */
+	EActiveTimerReturnType UpdateReplay(double InCurrentTime, float InDeltaTime);
+
+	/* Are we able to play? This controls the disabled state of the grid buttons, and is false while a new board generates */
+	bool CanPlay() const;
+
+	/* Shows the Game Over or You Win text once the board tells us the game has ended */
+	void HandleBoardChanged();
+
+	/* Keeps the probability overlay and the toolbar up to date as cells are revealed and flagged */
+	void HandleCellsChanged(TArrayView<const int32> ChangedCells);
+	void HandleChunkedCellsChanged(TArrayView<const FIntPoint> ChangedCells);
+
+	/* Push the counters, and which toolbar buttons can be used, to their widgets. Nothing they show changes unless the board,
+	 * the board being generated or the replay does, so this is called when those change rather than polled every frame.
+	 * The counters are kept by the board, so this never looks at the cells
+	 */
+	void UpdateToolbar();
+
+	/* Work out the mine probabilities and hand them to the view, or clear them if they aren't shown */
+	void UpdateProbabilities();
+
+	/* Left and right clicks on a cell of the board view */
+	void OnCellClicked(const FIntPoint& Cell);
+	void OnCellRightClicked(const FIntPoint& Cell);
+
+	int32 GetDesiredWidth() const;
+	void OnDesiredWidthChanged(int32 NewVal);
+
+	int32 GetDesiredHeight() const;
+	void OnDesiredHeightChanged(int32 NewVal);
+	
+	int64 GetDesiredMinesNum() const;
+    void OnDesiredMinesNumChanged(int64 NewVal);
+
+	bool IsDebugMinesEnabled() const;
+	ECheckBoxState GetDebugMinesState() const;
+	void OnDebugMinesChanged(ECheckBoxState NewState);
+
+	bool IsPlayerHintEnabled() const;
+	ECheckBoxState GetPlayerHintState() const;
+	void OnPlayerHintChanged(ECheckBoxState NewState);
+
+	bool IsNoGuessingEnabled() const;
+	ECheckBoxState GetNoGuessingState() const;
+	void OnNoGuessingChanged(ECheckBoxState NewState);
+
+	bool IsInfiniteBoardEnabled() const;
+	ECheckBoxState GetInfiniteBoardState() const;
+	void OnInfiniteBoardChanged(ECheckBoxState NewState);
+
+	/* Mines as a fraction of the cells of the board described by the toolbar, which is what an infinite board is dealt with */
+	double GetDesiredMineDensity() const;
+
+	/* Warn that an infinite board will be dealt with more mines than asked for, if it's too sparse to play */
+	void UpdateInfiniteDensityWarning();
+
+	bool IsShowProbabilitiesEnabled() const;
+	ECheckBoxState GetShowProbabilitiesState() const;
+	void OnShowProbabilitiesChanged(ECheckBoxState NewState);
+
+	bool IsRandomSeedEnabled() const;
+	ECheckBoxState GetRandomSeedState() const;
+	void OnRandomSeedChanged(ECheckBoxState NewState);
+
+	/* Show DesiredSeed in the toolbar, called whenever it changes */
+	void UpdateSeedText();
+	void OnDesiredSeedCommitted(const FText& NewText, ETextCommit::Type CommitType);
+
+	/* The seed to start a new game with, which rolls a new one first if we're using random seeds */
+	uint64 GetSeedForNewGame();
+
+	FReply OnGenerateGridClicked();
+
+	/* Reveal a cell the solver knows is safe. Only available on boards which aren't chunked */
+	FReply OnHintClicked();
+
+	/* Take back or make again the last move, including the one that lost the game. Only available on boards which aren't chunked */
+	FReply OnUndoClicked();
+	FReply OnRedoClicked();
+
+	/* Where the board is saved to and loaded from */
+	static FString GetSnapshotFilename();
+
+	FReply OnSaveClicked();
+
+	/* Replace the board with the saved one, switching between the dense and chunked board to match it */
+	FReply OnLoadClicked();
+
+	/* Replay the last recorded game in real time, from the board it was dealt */
+	FReply OnReplayClicked();
+
+	// The only widgets we reference later: the view we point at the board, the texts we show when the game ends
+	// and while a board is generating, and the parts of the toolbar that follow the game
+	TSharedPtr<class SMinesweeperBoardView> BoardView;
+	TSharedPtr<class STextBlock> GameOverText;
+	TSharedPtr<class STextBlock> GeneratingText;
+	TSharedPtr<class STextBlock> InfiniteDensityWarningText;
+	TSharedPtr<class STextBlock> CountersText;
+	TSharedPtr<class SEditableTextBox> SeedTextBox;
+	TSharedPtr<class SCheckBox> ShowProbabilitiesCheckBox;
+	TSharedPtr<class SButton> HintButton;
+	TSharedPtr<class SButton> UndoButton;
+	TSharedPtr<class SButton> RedoButton;
+	TSharedPtr<class SButton> SaveButton;
+
+	int32 DesiredWidth;
+	int32 DesiredHeight;
+	int64 DesiredMinesCount;
+	ECheckBoxState DebugMinesState;
+	ECheckBoxState PlayerHintState;
+	ECheckBoxState RandomSeedState;
+	ECheckBoxState InfiniteBoardState;
+	ECheckBoxState NoGuessingState;
+	ECheckBoxState ShowProbabilitiesState;
+	uint64 DesiredSeed;
+
+	// The game itself, the widget only observes it and forwards player input
+	// Only one of the boards is played at a time, the chunked one for boards too large to hold every cell
+	FMinesweeperBoard Board;
+	FMinesweeperChunkedBoard ChunkedBoard;
+	bool bUseChunkedBoard;
+
+	// Follows Board, so it must be declared after it
+	FMinesweeperSolver Solver;
+
+	// Mine probabilities for the overlay, worked out from what the solver couldn't deduce
+	FMinesweeperProbability Probability;
+
+	// The board being generated in the background, shared with the task generating it. Null when nothing is generating
+	TSharedPtr<FMinesweeperPendingBoard, ESPMode::ThreadSafe> PendingBoard;
+
+	// The last published board, holding the cells of the game before it, which the next board is generated into
+	TSharedPtr<FMinesweeperPendingBoard, ESPMode::ThreadSafe> SpareBoard;
+
+	// Polls PendingBoard until it's ready, only registered while something is generating
+	TWeakPtr<FActiveTimerHandle> GenerationTimer;
+
+	// Every game played on Board is recorded, so it can be replayed here or headless. Chunked boards aren't recorded
+	FMinesweeperRecorder Recorder;
+
+	// The recorded game being replayed, and the next of its inputs to play
+	FMinesweeperRecordedGame ReplayGame;
+	int32 NextReplayInput;
+	double ReplayStartSeconds;
+	bool bIsReplaying;
+
+	// Plays the replayed game's inputs as their time comes, only registered while replaying
+	TWeakPtr<FActiveTimerHandle> ReplayTimer;
+};
@@ -0,0 +1,156 @@
+﻿#pragma once
+#include "Widgets/SLeafWidget.h"
+
+class FMinesweeperBoard;
+class FMinesweeperChunkedBoard;
+struct FCellData;
+struct FButtonStyle;
+
+DECLARE_DELEGATE_OneParam(FOnMinesweeperCellClicked, const FIntPoint& /* Cell */);
+
+/*
+ * Draws a whole Minesweeper board as a single widget, rather than a button per cell.
+ * Cells are painted directly in OnPaint and clicks are hit tested against the cell grid, so layout costs the same
+ * however large the board is, and paint only depends on the number of cells that are visible.
+ * Boards which don't fit at MinCellSize can be scrolled with the mouse wheel (hold shift to scroll sideways)
+ * or dragged around with the middle mouse button.
+ * Cells are addressed by position (X is the column, Y is the row), so the view can draw both FMinesweeperBoard and
+ * FMinesweeperChunkedBoard, whose cells can't be indexed by an int32.
+ *
+ * Nothing is polled: the view listens to the board's change events, updates its cached display state for only the
+ * cells that changed, and invalidates its paint if any of them are visible. An idle board isn't repainted at all
+ * when it's inside an invalidation panel.
+ */
+class SMinesweeperBoardView : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS( SMinesweeperBoardView )
+		: _MinCellSize(24.f)
+	{}
+		/* Cells stretch to fill the widget, but are never drawn smaller than this. The board scrolls instead */
+		SLATE_ARGUMENT(float, MinCellSize)
+		SLATE_ARGUMENT(FSlateFontInfo, Font)
+
+		SLATE_EVENT(FOnMinesweeperCellClicked, OnCellClicked)
+		SLATE_EVENT(FOnMinesweeperCellClicked, OnCellRightClicked)
+	SLATE_END_ARGS()
+
+	SMinesweeperBoardView();
+	virtual ~SMinesweeperBoardView();
+
+	void Construct(const FArguments& InArgs);
+
+	/* Set the board to draw, which must stay alive for as long as we're drawing it. This replaces a board of either kind */
+	void SetBoard(FMinesweeperBoard* InBoard);
+	void SetBoard(FMinesweeperChunkedBoard* InChunkedBoard);
+
+	/* Scroll so that a cell is in the middle of the view, or as close to it as the edges of the board allow */
+	void CenterOnCell(const FIntPoint& Cell);
+
+	/* Should mines be drawn even while we're still playing? */
+	void SetShowMines(bool bInShowMines);
+
+	/* Tint every hidden cell from green to red by how likely it is to be a mine, indexed like the cells of the board
+	 * Only drawn for an FMinesweeperBoard, and an empty view turns the overlay off
+	 */
+	void SetMineProbabilities(TArrayView<const float> InMineProbabilities);
+
+	/* Number of label texts created since startup. Labels are shared and created once, so this stops growing
+	 * after the first paint however many cells are drawn, or for however many frames
+	 */
+	static int32 GetNumLabelTextsCreated();
+
+	// SWidget interface
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual void OnMouseLeave(const FPointerEvent& MouseEvent) override;
+	virtual void OnMouseCaptureLost(const FCaptureLostEvent& CaptureLostEvent) override;
+	// End of SWidget interface
+
+protected:
+	// SWidget interface
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+	// End of SWidget interface
+
+private:
+	/* Size of a cell, stretched to fit the board into the geometry if it can */
+	float GetCellSize(const FGeometry& Geometry) const;
+
+	/* How far the board has been scrolled, clamped so we never scroll past its edges
+	 * Offsets are doubles, as a float can't hold a position on a board of millions of cells to the pixel
+	 */
+	void GetScrollOffset(const FGeometry& Geometry, double& OutX, double& OutY) const;
+	void SetScrollOffset(const FGeometry& Geometry, double X, double Y);
+	void ClampScrollOffset(const FGeometry& Geometry, double& InOutX, double& InOutY) const;
+
+	/* Column or row at an offset into the board, clamped to the board */
+	static int32 GetCellAtOffset(double Offset, float CellSize, int32 NumCells);
+
+	/* Returns the cell under a screen space position, or FIntPoint::NoneValue if there isn't one */
+	FIntPoint GetCellAt(const FGeometry& Geometry, const FVector2D& ScreenSpacePosition) const;
+
+	/* Text to draw for a cell's display state, empty if there's nothing to draw */
+	static const FText& GetCellLabel(uint8 DisplayState);
+
+	/* Work out how a cell should be drawn */
+	uint8 ComputeCellDisplayState(const FCellData& Cell, bool bCanPlay) const;
+
+	/* How a cell should be drawn right now, from the cache for a board or from the cell itself for a chunked board */
+	uint8 GetCellDisplayState(const FIntPoint& Cell) const;
+
+	/* Stop listening to and drawing whichever board we have */
+	void ClearBoard();
+
+	bool HasBoard() const;
+	int32 GetBoardWidth() const;
+	int32 GetBoardHeight() const;
+
+	/* Board events, which update the cached display state of the cells and invalidate us if needed */
+	void HandleCellsChanged(TArrayView<const int32> ChangedCells);
+	void HandleChunkedCellsChanged(TArrayView<const FIntPoint> ChangedCells);
+	void HandleBoardChanged();
+
+	/* Invalidate our paint if a hovered or pressed cell changed, as that changes how it's drawn */
+	void SetHoveredCell(const FIntPoint& Cell);
+	void SetPressedCell(const FIntPoint& Cell);
+
+	/* Report any change in the memory held by our caches to the board view memory stat */
+	void UpdateMemoryStats();
+
+	// We draw one of these, never both
+	FMinesweeperBoard* Board;
+	FMinesweeperChunkedBoard* ChunkedBoard;
+	const FButtonStyle* ButtonStyle;
+	FSlateFontInfo Font;
+	float MinCellSize;
+	bool bShowMines;
+
+	// Display state of every cell on a board, kept up to date from the board's events. Unused for chunked boards
+	TArray<uint8> CellDisplayStates;
+
+	// Chance of each cell of a board being a mine, drawn over the hidden cells. Empty when there's no overlay
+	TArray<float> MineProbabilities;
+
+	// Measured size of each display state's label in our font, filled in by our first paint
+	mutable TArray<FVector2D> CellLabelSizes;
+
+	// The cells drawn by our last paint, so we know whether a change to a cell is visible
+	mutable FIntRect PaintedCells;
+
+	// Memory last reported to the board view memory stat, which is taken back out when we're destroyed
+	SIZE_T ReportedAllocatedSize;
+
+	FOnMinesweeperCellClicked OnCellClicked;
+	FOnMinesweeperCellClicked OnCellRightClicked;
+
+	// Mouse state, so cells are drawn hovered/pressed and a click only counts if it's released over the cell it started on
+	FIntPoint HoveredCell;
+	FIntPoint PressedCell;
+	FKey PressedButton;
+	bool bIsPanning;
+	double ScrollOffsetX;
+	double ScrollOffsetY;
+};